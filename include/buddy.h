@@ -3,7 +3,7 @@
 
 #include <vector>
 #include <unordered_map>
-#include <list>
+#include <cstdint>
 using namespace std;
 
 class BuddyAllocator {
@@ -13,26 +13,71 @@ private:
     int max_order;
     int used_memory = 0;
 
-    vector<list<int>> free_list;
-    unordered_map<int,int> allocated_order;
-    unordered_map<int,int> requested_size;  
+    // Free lists are intrusive and indexed by block number (addr >> min_order):
+    // free_order[b] is the order of the free block starting at b, or -1,
+    // which makes the buddy check and its unlink O(1).
+    vector<int> free_head;
+    vector<int> free_tail;
+    vector<int> next_free;
+    vector<int> prev_free;
+    vector<signed char> free_order;
+    // Allocation metadata, dense and indexed by addr >> min_order.
+    // alloc_order is NO_ORDER for blocks that do not start an allocation.
+    static constexpr uint8_t NO_ORDER = 0xFF;
+    vector<uint8_t> alloc_order;
+    vector<uint32_t> requested_size;
+    vector<uint32_t> block_id;
+    unordered_map<int,int> id_to_addr;
+    int internal_frag = 0;
+
+    // Lazy (deferred) coalescing state. lazy_free marks free blocks that
+    // skipped coalescing; lazy_count holds how many sit on each order.
+    bool lazy = false;
+    int lazy_watermark = 8;
+    vector<uint8_t> lazy_free;
+    vector<int> lazy_count;
+    int lazy_blocks = 0;
+
+    long long split_count = 0;
+    long long merge_count = 0;
 
     int size_to_order(int size);
     bool is_power_of_two(int x);
 
+    void push_free(int addr, int order);
+    int pop_free(int order);
+    void unlink_free(int addr, int order);
+    void clear_lazy(int addr, int order);
+
+    void record_allocation(int addr, int order, int size);
+    int release_allocation(int addr);
+    void coalesce(int addr, int order);
+    void release_block(int addr, int order);
+
 public:
     BuddyAllocator(int memory_size, int min_block_size);
 
     int buddy_malloc(int size);
     void buddy_free(int addr);
 
+    int buddy_malloc_n(int size, int count, vector<int> &out);
+    void buddy_free_n(vector<int> addrs);
+
+    void set_lazy(bool enabled, int watermark = 8);
+    bool is_lazy() const;
+    void coalesce_all();
+
     int get_used_memory() const;
+    long long get_split_count() const;
+    long long get_merge_count() const;
     void dump_free_lists();
 
     int get_internal_fragmentation() const;
     void dump_allocations() const;
 
     int get_order(int addr) const;
+    int get_block_id(int addr) const;
+    int find_block(int id) const;
 };
 
 #endif
\ No newline at end of file
@@ -2,40 +2,414 @@
 #define CACHE_H
 
 #include <vector>
-#include <queue>
+#include <array>
 #include <string>
+#include <stdexcept>
+#include <iostream>
+#include <cstdint>
+#include <memory>
+#include "cache_policy.h"
+#include "set_stats.h"
 
-struct CacheLine {
-    bool valid;
-    int tag;
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+enum AccessType {
+    ACCESS_READ,
+    ACCESS_WRITE
+};
+
+enum WritePolicy {
+    WRITE_BACK = 1,     // writes mark the block dirty; it is written on eviction
+    WRITE_THROUGH       // every write is passed on to the next level
+};
+
+enum WriteMissPolicy {
+    WRITE_ALLOCATE = 1,
+    NO_WRITE_ALLOCATE   // write misses bypass the cache
+};
+
+// Tags are stored per set in a contiguous struct-of-arrays layout, padded
+// to whole 8-lane groups so a set can be searched with vector compares.
+// Real tags are non-negative; the sentinels below mark invalid ways and the
+// padding lanes past the associativity.
+static const int32_t TAG_INVALID = -1;
+static const int32_t TAG_PAD = INT32_MIN;
+
+struct alignas(32) TagGroup {
+    int32_t tag[8];
 };
+
+// Index of the first lane equal to key across `groups` groups, or -1.
+// The instruction set is picked at build time (see ARCHFLAGS in the Makefile).
+inline int find_tag(const TagGroup *g, int groups, int32_t key) {
+#if defined(__AVX2__)
+    __m256i k = _mm256_set1_epi32(key);
+    for (int i = 0; i < groups; i++) {
+        __m256i t = _mm256_load_si256((const __m256i *)g[i].tag);
+        int m = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(t, k)));
+        if (m)
+            return i * 8 + __builtin_ctz(m);
+    }
+#elif defined(__SSE2__)
+    __m128i k = _mm_set1_epi32(key);
+    for (int i = 0; i < groups; i++) {
+        __m128i lo = _mm_load_si128((const __m128i *)g[i].tag);
+        __m128i hi = _mm_load_si128((const __m128i *)(g[i].tag + 4));
+        int m = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(lo, k)))
+              | _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(hi, k))) << 4;
+        if (m)
+            return i * 8 + __builtin_ctz(m);
+    }
+#else
+    for (int i = 0; i < groups; i++)
+        for (int j = 0; j < 8; j++)
+            if (g[i].tag[j] == key)
+                return i * 8 + j;
+#endif
+    return -1;
+}
+
 extern int l1_penalty;
 extern int l2_penalty;
 extern int memory_penalty;
 
-extern int total_cycles;
+extern long long total_cycles;
+
+// Geometry: how an address splits into (set, tag) and how the tag array is
+// stored. DynamicGeometry takes the sizes at run time and uses shifts and
+// masks whenever the block size and set count are powers of two, falling
+// back to division otherwise. StaticGeometry fixes a power-of-two geometry
+// at compile time, so the split is constant shifts and the tags live in a
+// fixed-size array.
+struct DynamicGeometry {
+    typedef std::vector<TagGroup> Store;
+
+    int num_sets;
+    int ways;
+    int groups;
+
+    int block_size;
+    bool pow2;
+    int block_shift;
+    int set_shift;
+    int set_mask;
+
+    DynamicGeometry(int C, int b, int N) : ways(N), block_size(b) {
+        num_sets = (C / b) / N;
+        groups = (N + 7) / 8;
+
+        pow2 = is_pow2(b) && is_pow2(num_sets);
+        block_shift = log2i(b);
+        set_shift = log2i(num_sets);
+        set_mask = num_sets - 1;
+    }
+
+    void split(int address, int &set, int &tag) const {
+        if (pow2) {
+            int block_number = address >> block_shift;
+            set = block_number & set_mask;
+            tag = block_number >> set_shift;
+        } else {
+            int block_number = address / block_size;
+            set = block_number % num_sets;
+            tag = block_number / num_sets;
+        }
+    }
 
-class Cache {
+    int join(int set, int tag) const {
+        if (pow2)
+            return ((tag << set_shift) | set) << block_shift;
+        return (tag * num_sets + set) * block_size;
+    }
+
+    void size_store(Store &s) const { s.resize((size_t)num_sets * groups); }
+
+    static bool is_pow2(int x) { return x > 0 && !(x & (x - 1)); }
+    static int log2i(int x) {
+        int n = 0;
+        while (x > 1) {
+            x >>= 1;
+            n++;
+        }
+        return n;
+    }
+};
+
+template <int BlockBits, int SetBits, int Ways>
+struct StaticGeometry {
+    static_assert(Ways > 0 && BlockBits >= 0 && SetBits >= 0, "bad cache geometry");
+
+    static constexpr int block_size = 1 << BlockBits;
+    static constexpr int num_sets = 1 << SetBits;
+    static constexpr int ways = Ways;
+    static constexpr int groups = (Ways + 7) / 8;
+    static constexpr int cache_size = block_size * num_sets * Ways;
+
+    typedef std::array<TagGroup, (size_t)num_sets * groups> Store;
+
+    StaticGeometry() {}
+    StaticGeometry(int C, int b, int N) {
+        if (C != cache_size || b != block_size || N != Ways)
+            throw std::invalid_argument("cache size does not match the fixed geometry");
+    }
+
+    static void split(int address, int &set, int &tag) {
+        int block_number = address >> BlockBits;
+        set = block_number & (num_sets - 1);
+        tag = block_number >> SetBits;
+    }
+
+    static int join(int set, int tag) {
+        return ((tag << SetBits) | set) << BlockBits;
+    }
+
+    static void size_store(Store &) {}
+};
+
+// Set-associative cache. The replacement policy is a template parameter
+// (see cache_policy.h) so the per-access policy hooks are resolved and
+// inlined at compile time rather than dispatched virtually.
+template <class Policy, class Geometry = DynamicGeometry>
+class BasicCache {
 private:
-    int cache_size;    
-    int block_size;    
-    int associativity; 
-    int num_sets;     
+    Geometry geo;
 
-    std::vector<std::vector<CacheLine>> sets;
-    std::vector<std::queue<int>> fifo;
+    typename Geometry::Store tags;  // num_sets x groups
+    std::vector<uint8_t> dirty;     // num_sets x ways
+    Policy policy;
+
+    WritePolicy write_policy = WRITE_BACK;
+    WriteMissPolicy write_miss = WRITE_ALLOCATE;
 
     int accesses = 0;
     int hits = 0;
     int misses = 0;
+    int writes = 0;
+    int writebacks = 0;         // dirty blocks evicted
+    int write_throughs = 0;     // writes passed on without a writeback
+    bool victim_dirty = false;  // whether the last fill evicted a dirty block
+
+    std::unique_ptr<SetStats> set_stats;    // off unless enabled
+
+    TagGroup *set_groups(int set) { return &tags[(size_t)set * geo.groups]; }
+
+    void init() {
+        geo.size_store(tags);
+        for (int s = 0; s < geo.num_sets; s++) {
+            int32_t *t = set_groups(s)->tag;
+            for (int i = 0; i < geo.groups * 8; i++)
+                t[i] = (i < geo.ways) ? TAG_INVALID : TAG_PAD;
+        }
+        dirty.assign((size_t)geo.num_sets * geo.ways, 0);
+        policy.init(geo.num_sets, geo.ways);
+    }
+
+    uint8_t &dirty_bit(int set, int way) { return dirty[(size_t)set * geo.ways + way]; }
+
+    // Returns the base address of the evicted block, or -1.
+    int fill(int set, int tag, bool make_dirty = false) {
+        int evicted = -1;
+        victim_dirty = false;
+        int way = find_tag(set_groups(set), geo.groups, TAG_INVALID);
+        if (way < 0) {
+            way = policy.victim(set);
+            evicted = geo.join(set, set_groups(set)->tag[way]);
+            if (dirty_bit(set, way)) {
+                victim_dirty = true;
+                writebacks++;
+            }
+        }
+
+        set_groups(set)->tag[way] = tag;
+        dirty_bit(set, way) = make_dirty;
+        policy.on_fill(set, way);
+        return evicted;
+    }
+
+    // The write half of access(); way is -1 on a miss.
+    void write(int set, int way, int tag) {
+        writes++;
+        if (way >= 0) {
+            if (write_policy == WRITE_BACK)
+                dirty_bit(set, way) = 1;
+            else
+                write_throughs++;
+            return;
+        }
+
+        if (write_miss == WRITE_ALLOCATE)
+            fill(set, tag, write_policy == WRITE_BACK);
+        if (write_miss == NO_WRITE_ALLOCATE || write_policy == WRITE_THROUGH)
+            write_throughs++;
+    }
 
 public:
-    Cache(int C, int b, int N);
+    BasicCache(int C, int b, int N, Policy p = Policy())
+        : geo(C, b, N), policy(p) {
+        init();
+    }
+
+    // Only for fixed geometries, which need no sizes.
+    template <class G = Geometry, int = G::cache_size>
+    explicit BasicCache(Policy p = Policy())
+        : policy(p) {
+        init();
+    }
+
+    // Starts per-set counting and miss classification (see set_stats.h).
+    void enable_set_stats() {
+        set_stats.reset(new SetStats(geo.num_sets, geo.num_sets * geo.ways));
+    }
+    const SetStats *get_set_stats() const { return set_stats.get(); }
+
+    void set_write_policy(WritePolicy wp, WriteMissPolicy wm) {
+        write_policy = wp;
+        write_miss = wm;
+    }
+
+    // Looks the address up and, on a read miss, brings its block in. Writes
+    // follow the write and write-miss policies.
+    bool access(int address, AccessType type = ACCESS_READ) {
+        accesses++;
+
+        int set, tag;
+        geo.split(address, set, tag);
+
+        int way = find_tag(set_groups(set), geo.groups, tag);
+        if (way >= 0) {
+            hits++;
+            policy.on_hit(set, way);
+        } else {
+            misses++;
+        }
+        if (set_stats)
+            set_stats->record(set, geo.join(set, tag), way >= 0);
+
+        if (type == ACCESS_WRITE)
+            write(set, way, tag);
+        else if (way < 0)
+            fill(set, tag);
+        return way >= 0;
+    }
+
+    // Counted lookup that leaves the cache contents unchanged on a miss.
+    bool lookup(int address) {
+        accesses++;
+
+        int set, tag;
+        geo.split(address, set, tag);
+
+        int way = find_tag(set_groups(set), geo.groups, tag);
+        if (set_stats)
+            set_stats->record(set, geo.join(set, tag), way >= 0);
+        if (way >= 0) {
+            hits++;
+            policy.on_hit(set, way);
+            return true;
+        }
 
-    bool access(int address);   
-    void insert(int address);
+        misses++;
+        return false;
+    }
 
-    void print_stats(const std::string &name) const;
+    // Places the address's block without counting an access. Returns the
+    // base address of the block it evicted, or -1; *evicted_dirty tells
+    // whether that block was dirty. A block already present is only touched
+    // (and marked dirty if `make_dirty`).
+    int insert(int address, bool make_dirty = false, bool *evicted_dirty = nullptr) {
+        int set, tag;
+        geo.split(address, set, tag);
+
+        int evicted = -1;
+        int way = find_tag(set_groups(set), geo.groups, tag);
+        if (way >= 0) {
+            policy.on_hit(set, way);
+            if (make_dirty)
+                dirty_bit(set, way) = 1;
+            victim_dirty = false;
+        } else {
+            evicted = fill(set, tag, make_dirty);
+        }
+
+        if (evicted_dirty)
+            *evicted_dirty = victim_dirty;
+        return evicted;
+    }
+
+    bool contains(int address) {
+        int set, tag;
+        geo.split(address, set, tag);
+        return find_tag(set_groups(set), geo.groups, tag) >= 0;
+    }
+
+    // Marks a present block dirty; false if the block is not cached.
+    bool mark_dirty(int address) {
+        int set, tag;
+        geo.split(address, set, tag);
+
+        int way = find_tag(set_groups(set), geo.groups, tag);
+        if (way < 0)
+            return false;
+        dirty_bit(set, way) = 1;
+        return true;
+    }
+
+    bool is_dirty(int address) {
+        int set, tag;
+        geo.split(address, set, tag);
+
+        int way = find_tag(set_groups(set), geo.groups, tag);
+        return way >= 0 && dirty_bit(set, way);
+    }
+
+    // Drops the block. *was_dirty tells the caller whether it still has to
+    // write the data back.
+    bool invalidate(int address, bool *was_dirty = nullptr) {
+        int set, tag;
+        geo.split(address, set, tag);
+
+        int way = find_tag(set_groups(set), geo.groups, tag);
+        if (was_dirty)
+            *was_dirty = way >= 0 && dirty_bit(set, way);
+        if (way < 0)
+            return false;
+        set_groups(set)->tag[way] = TAG_INVALID;
+        dirty_bit(set, way) = 0;
+        return true;
+    }
+
+    void print_stats(const std::string &name) const {
+        std::cout << name << " Accesses: " << accesses << "\n";
+        std::cout << name << " Hits: " << hits << "\n";
+        std::cout << name << " Misses: " << misses << "\n";
+
+        if (accesses > 0)
+            std::cout << name << " Hit Ratio: "
+                      << (hits * 100.0 / accesses) << "%\n";
+    }
+
+    int get_block_size() const { return geo.block_size; }
+    const char *policy_name() const { return Policy::name(); }
+
+    int get_accesses() const { return accesses; }
+    int get_hits() const { return hits; }
+    int get_misses() const { return misses; }
+    int get_writes() const { return writes; }
+    int get_writebacks() const { return writebacks; }
+    int get_write_throughs() const { return write_throughs; }
 };
 
-#endif
\ No newline at end of file
+typedef BasicCache<FifoPolicy>     Cache;
+typedef BasicCache<LruPolicy>      LruCache;
+typedef BasicCache<TreePlruPolicy> PlruCache;
+typedef BasicCache<SrripPolicy>    SrripCache;
+typedef BasicCache<RandomPolicy>   RandomCache;
+
+// Compile-time geometry, e.g. FixedCache<6, 6, 8> is a 32KB, 64B-block,
+// 8-way cache. Allocate large ones on the heap: the tags are stored inline.
+template <int BlockBits, int SetBits, int Ways, class Policy = FifoPolicy>
+using FixedCache = BasicCache<Policy, StaticGeometry<BlockBits, SetBits, Ways>>;
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef CACHE_HIERARCHY_H
+#define CACHE_HIERARCHY_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <deque>
+#include <unordered_map>
+#include "cache.h"
+#include "prefetch.h"
+using namespace std;
+
+enum CachePolicy {
+    POLICY_FIFO = 1,
+    POLICY_LRU,
+    POLICY_PLRU,
+    POLICY_SRRIP,
+    POLICY_RANDOM
+};
+
+enum InclusionPolicy {
+    INCL_NINE = 1,      // non-inclusive non-exclusive
+    INCL_INCLUSIVE,
+    INCL_EXCLUSIVE
+};
+
+// One level of the hierarchy. Levels may use different replacement policies,
+// so the hierarchy talks to them through this interface; the cache itself
+// stays a statically dispatched BasicCache.
+class CacheLevel {
+public:
+    virtual ~CacheLevel() {}
+
+    virtual bool lookup(int address) = 0;
+    // Evicted block address or -1, as for BasicCache::insert.
+    virtual int insert(int address, bool dirty, bool *victim_dirty) = 0;
+    virtual bool invalidate(int address, bool *was_dirty) = 0;
+    virtual bool contains(int address) = 0;
+    virtual bool mark_dirty(int address) = 0;
+    virtual void enable_set_stats() = 0;
+    virtual const SetStats *get_set_stats() const = 0;
+
+    virtual int get_block_size() const = 0;
+    virtual const char *policy_name() const = 0;
+    virtual void print_stats(const string &name) const = 0;
+    virtual int get_accesses() const = 0;
+    virtual int get_hits() const = 0;
+    virtual int get_misses() const = 0;
+};
+
+template <class C>
+class CacheLevelOf : public CacheLevel {
+    C cache;
+
+public:
+    CacheLevelOf(int size, int block, int ways) : cache(size, block, ways) {}
+
+    bool lookup(int address) override { return cache.lookup(address); }
+    int insert(int address, bool dirty, bool *victim_dirty) override {
+        return cache.insert(address, dirty, victim_dirty);
+    }
+    bool invalidate(int address, bool *was_dirty) override { return cache.invalidate(address, was_dirty); }
+    bool contains(int address) override { return cache.contains(address); }
+    bool mark_dirty(int address) override { return cache.mark_dirty(address); }
+    void enable_set_stats() override { cache.enable_set_stats(); }
+    const SetStats *get_set_stats() const override { return cache.get_set_stats(); }
+
+    int get_block_size() const override { return cache.get_block_size(); }
+    const char *policy_name() const override { return cache.policy_name(); }
+    void print_stats(const string &name) const override { cache.print_stats(name); }
+    int get_accesses() const override { return cache.get_accesses(); }
+    int get_hits() const override { return cache.get_hits(); }
+    int get_misses() const override { return cache.get_misses(); }
+};
+
+CacheLevel *make_cache_level(CachePolicy policy, int size, int block, int ways);
+
+// Any number of cache levels in front of main memory. Each level charges
+// its own latency when it is probed; a miss in every level also charges the
+// memory latency.
+class CacheHierarchy {
+private:
+    // A block brought in by a prefetch that no demand access has used yet,
+    // and the cycle at which its data arrives.
+    struct PendingPrefetch {
+        long long ready;
+        bool in_buffer;
+    };
+
+    struct Level {
+        unique_ptr<CacheLevel> cache;
+        int latency;
+
+        unique_ptr<Prefetcher> prefetcher;
+        unordered_map<int, PendingPrefetch> pending;   // by block address
+        deque<int> buffer;                             // prefetch buffer, FIFO
+        long long issued = 0;
+        long long useful = 0;
+        long long late = 0;
+        long long useless = 0;
+        long long demand_misses = 0;     // misses the prefetcher did not cover
+        long long writebacks = 0;        // dirty blocks written to the next level
+
+        // Optional fully associative victim cache holding this level's
+        // recent victims; a block in it still belongs to this level.
+        unique_ptr<LruCache> victims;
+        int victim_entries = 0;
+        long long victim_probes = 0;
+        long long victim_hits = 0;
+    };
+
+    static const int PREFETCH_BUFFER_BLOCKS = 16;
+    static const int VICTIM_CACHE_LATENCY = 1;
+
+    vector<Level> levels;
+    InclusionPolicy inclusion;
+    int memory_latency;
+    WritePolicy write_policy = WRITE_BACK;
+    WriteMissPolicy write_miss = WRITE_ALLOCATE;
+
+    long long accesses = 0;
+    long long cycles = 0;
+    long long back_invalidations = 0;
+    long long writes = 0;
+    long long memory_writes = 0;
+
+    vector<int> candidates;     // scratch for prefetch proposals
+
+    int block_of(int level, int address) const;
+    int insert_block(int level, int address, bool dirty = false, bool *victim_dirty = nullptr);
+    bool drop_block(int level, int address, bool *was_dirty = nullptr);
+    bool held(int level, int address);
+    int spill(int level, int block_addr, bool &dirty);
+    bool back_invalidate(int level, int block_addr);
+    void evict(int level, int block_addr, bool dirty, int &spent);
+    void write_back(int level, int block_addr, int &spent);
+    void fill_exclusive(int level, int address, bool dirty, int &spent);
+    void fill_inclusive(int level, int address, int &spent);
+    int use_prefetch(int level, int block_addr);
+    void issue_prefetches(int level, int block_addr, PrefetchOutcome outcome, int &spent);
+
+public:
+    CacheHierarchy(InclusionPolicy inclusion, int memory_latency);
+
+    void add_level(CacheLevel *cache, int latency);
+    // Attaches a prefetcher (or none) to a level; the hierarchy owns it.
+    // Stream buffers fill a small prefetch buffer beside the cache, the
+    // others fill the cache itself.
+    void set_prefetcher(int level, Prefetcher *prefetcher);
+    // Applies to every level. The default is write-back, write-allocate.
+    void set_write_policy(WritePolicy wp, WriteMissPolicy wm);
+    // Puts a fully associative LRU victim cache of `entries` blocks behind
+    // a level (0 removes it).
+    void set_victim_cache(int level, int entries);
+    void enable_set_stats();
+
+    // Returns the index of the level that hit, or level_count() for main
+    // memory. *cost receives the cycles charged for this access, including
+    // any writebacks it caused.
+    int access(int address, int *cost = nullptr, AccessType type = ACCESS_READ);
+
+    int level_count() const { return (int)levels.size(); }
+    CacheLevel &level(int i) { return *levels[i].cache; }
+    int level_latency(int i) const { return levels[i].latency; }
+    const char *prefetcher_name(int i) const;
+    InclusionPolicy get_inclusion() const { return inclusion; }
+    int get_memory_latency() const { return memory_latency; }
+
+    long long get_accesses() const { return accesses; }
+    long long get_cycles() const { return cycles; }
+    long long get_back_invalidations() const { return back_invalidations; }
+    long long get_writes() const { return writes; }
+    long long get_writebacks(int level) const { return levels[level].writebacks; }
+    long long get_memory_writes() const { return memory_writes; }
+    double average_latency() const;
+
+    void print_stats() const;
+    // CSV histogram of every level's per-set counters (see SetStats).
+    // Returns false if no level collects them.
+    bool write_set_histogram(ostream &out) const;
+};
+
+const char *inclusion_name(InclusionPolicy p);
+const char *write_policy_name(WritePolicy p);
+const char *write_miss_name(WriteMissPolicy p);
+
+#endif
@@ -0,0 +1,199 @@
+#ifndef CACHE_POLICY_H
+#define CACHE_POLICY_H
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+// Replacement policies for BasicCache. Each policy keeps its own compact
+// per-set state and exposes the same four hooks; BasicCache takes the policy
+// as a template parameter so these calls are inlined into access()/insert().
+//
+//   init(sets, ways)   size the state
+//   on_hit(set, way)   a lookup hit this way
+//   on_fill(set, way)  a new block was placed in this way
+//   victim(set)        pick the way to evict (all ways are valid)
+//
+// Per-line state is 16 bits wide, so no policy supports more than
+// MAX_CACHE_WAYS ways; init() rejects larger sets.
+
+const int MAX_CACHE_WAYS = 65536;
+
+inline void check_policy_ways(int ways) {
+    if (ways < 1 || ways > MAX_CACHE_WAYS)
+        throw std::invalid_argument("cache associativity must be between 1 and 65536 ways");
+}
+
+// First-in first-out: a round-robin pointer per set. Invalid ways are filled
+// first in index order, so the pointer visits ways in insertion order.
+class FifoPolicy {
+    std::vector<uint16_t> next;
+    int ways = 0;
+
+public:
+    static const char *name() { return "FIFO"; }
+
+    void init(int sets, int n) {
+        check_policy_ways(n);
+        ways = n;
+        next.assign(sets, 0);
+    }
+    void on_hit(int, int) {}
+    void on_fill(int, int) {}
+    int victim(int set) {
+        int v = next[set];
+        next[set] = (v + 1 == ways) ? 0 : v + 1;
+        return v;
+    }
+};
+
+// True LRU with an age rank per line: 0 is most recent, ways-1 the victim.
+class LruPolicy {
+    std::vector<uint16_t> age;
+    int ways = 0;
+
+    // n is copied to a local: stores through uint16_t* may alias the member,
+    // which would otherwise block vectorising the loop.
+    void touch(int set, int way) {
+        int n = ways;
+        uint16_t *a = &age[(size_t)set * n];
+        uint16_t old = a[way];
+        for (int w = 0; w < n; w++)
+            a[w] += (a[w] < old);
+        a[way] = 0;
+    }
+
+public:
+    static const char *name() { return "LRU"; }
+
+    void init(int sets, int n) {
+        check_policy_ways(n);
+        ways = n;
+        age.resize((size_t)sets * ways);
+        for (int s = 0; s < sets; s++)
+            for (int w = 0; w < ways; w++)
+                age[(size_t)s * ways + w] = (uint16_t)(ways - 1 - w);
+    }
+    void on_hit(int set, int way) { touch(set, way); }
+    void on_fill(int set, int way) { touch(set, way); }
+    int victim(int set) {
+        int n = ways;
+        const uint16_t *a = &age[(size_t)set * n];
+        // Exactly one way holds the oldest rank; scanning all ways without an
+        // early exit avoids a mispredicted branch on nearly every miss.
+        int v = 0;
+        for (int w = 0; w < n; w++)
+            v = (a[w] == n - 1) ? w : v;
+        return v;
+    }
+};
+
+// Tree pseudo-LRU: ways-1 direction bits per set, stored as a heap-ordered
+// bit tree (node 1 is the root) in one or more 64-bit words per set. Each
+// bit points towards the colder half. Non power-of-two associativities use
+// the next power-of-two tree and never descend into the missing ways.
+class TreePlruPolicy {
+    std::vector<uint64_t> bits;     // sets x words
+    int ways = 0;
+    int leaves = 1;
+    int words = 1;
+
+public:
+    static const char *name() { return "PLRU"; }
+
+    void init(int sets, int n) {
+        check_policy_ways(n);
+        ways = n;
+        leaves = 1;
+        while (leaves < ways)
+            leaves <<= 1;
+        words = (leaves + 63) / 64;
+        bits.assign((size_t)sets * words, 0);
+    }
+    void on_hit(int set, int way) { on_fill(set, way); }
+    void on_fill(int set, int way) {
+        uint64_t *b = &bits[(size_t)set * words];
+        int node = 1, lo = 0, span = leaves;
+        while (span > 1) {
+            span >>= 1;
+            bool right = way >= lo + span;
+            if (right) {
+                b[node >> 6] &= ~(1ull << (node & 63));
+                lo += span;
+            } else {
+                b[node >> 6] |= 1ull << (node & 63);
+            }
+            node = 2 * node + right;
+        }
+    }
+    int victim(int set) {
+        const uint64_t *b = &bits[(size_t)set * words];
+        int node = 1, lo = 0, span = leaves;
+        while (span > 1) {
+            span >>= 1;
+            bool right = (b[node >> 6] >> (node & 63)) & 1;
+            if (right && lo + span >= ways)
+                right = false;
+            if (right)
+                lo += span;
+            node = 2 * node + right;
+        }
+        return lo;
+    }
+};
+
+// Static RRIP with 2-bit re-reference prediction values: fills predict a
+// long re-reference interval (2), hits reset to near-immediate (0) and the
+// victim is the first way at distant (3), ageing the set until one exists.
+class SrripPolicy {
+    std::vector<uint8_t> rrpv;
+    int ways = 0;
+
+public:
+    static const char *name() { return "SRRIP"; }
+
+    void init(int sets, int n) {
+        check_policy_ways(n);
+        ways = n;
+        rrpv.assign((size_t)sets * ways, 3);
+    }
+    void on_hit(int set, int way) { rrpv[(size_t)set * ways + way] = 0; }
+    void on_fill(int set, int way) { rrpv[(size_t)set * ways + way] = 2; }
+    int victim(int set) {
+        uint8_t *r = &rrpv[(size_t)set * ways];
+        while (true) {
+            for (int w = 0; w < ways; w++)
+                if (r[w] == 3)
+                    return w;
+            for (int w = 0; w < ways; w++)
+                r[w]++;
+        }
+    }
+};
+
+// Uniform random victim from a seeded xorshift32 generator, so runs are
+// reproducible.
+class RandomPolicy {
+    uint32_t state;
+    int ways = 0;
+
+public:
+    static const char *name() { return "Random"; }
+
+    explicit RandomPolicy(uint32_t seed = 0x9E3779B9u) : state(seed ? seed : 1) {}
+
+    void init(int, int n) {
+        check_policy_ways(n);
+        ways = n;
+    }
+    void on_hit(int, int) {}
+    void on_fill(int, int) {}
+    int victim(int) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (int)(state % (uint32_t)ways);
+    }
+};
+
+#endif
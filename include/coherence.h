@@ -0,0 +1,92 @@
+#ifndef COHERENCE_H
+#define COHERENCE_H
+
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include "cache.h"
+#include "event_sink.h"
+using namespace std;
+
+enum CoherenceProtocol {
+    PROTO_MESI = 1,
+    PROTO_MOESI
+};
+
+struct CoherenceResult {
+    CoherenceSource source;
+    int peer;           // supplying core for SRC_PEER, otherwise -1
+    int invalidated;    // copies invalidated in other cores
+    int cycles;
+};
+
+// Multi-core model: one private L1 per core in front of a shared LLC, kept
+// coherent with MESI or MOESI. A directory records, for every line, which
+// cores hold it and which core owns it; each core's state follows from that:
+//
+//   not a sharer                 I
+//   owner, clean                 E
+//   owner, dirty, sole sharer    M
+//   owner, dirty, shared         O (MOESI only)
+//   other sharers                S
+class CoherentSystem {
+private:
+    struct LineState {
+        uint64_t sharers = 0;
+        int owner = -1;
+        bool dirty = false;
+        // Cores whose copy was invalidated by another core's write and who
+        // have not re-fetched it yet, and the words written since then.
+        uint64_t lost = 0;
+        vector<uint64_t> written;
+    };
+
+    int cores;
+    int block_size;
+    int word_size;
+    CoherenceProtocol protocol;
+
+    vector<unique_ptr<Cache>> l1;
+    unique_ptr<Cache> llc;
+    unordered_map<int, LineState> lines;
+
+    long long invalidations = 0;
+    long long upgrades = 0;
+    long long coherence_misses = 0;
+    long long false_sharing_misses = 0;
+    long long peer_transfers = 0;
+    long long writebacks = 0;
+
+    int word_bit(int address) const;
+    void evict_from_l1(int core, int line_addr);
+    int invalidate_others(int core, int line_addr, LineState &st, uint64_t word);
+    void note_write(int core, LineState &st, uint64_t word);
+    CoherenceSource fetch_shared(int line_addr);
+
+public:
+    CoherentSystem(int cores, int l1_size, int block, int l1_ways,
+                   int llc_size, int llc_ways, CoherenceProtocol protocol);
+
+    CoherenceResult access(int core, int address, AccessType type);
+
+    // 'M', 'O', 'E', 'S' or 'I'.
+    char state_of(int core, int address) const;
+
+    int core_count() const { return cores; }
+    CoherenceProtocol get_protocol() const { return protocol; }
+
+    long long get_invalidations() const { return invalidations; }
+    long long get_upgrades() const { return upgrades; }
+    long long get_coherence_misses() const { return coherence_misses; }
+    long long get_false_sharing_misses() const { return false_sharing_misses; }
+    long long get_peer_transfers() const { return peer_transfers; }
+    long long get_writebacks() const { return writebacks; }
+
+    void print_stats() const;
+};
+
+const char *protocol_name(CoherenceProtocol p);
+
+#endif
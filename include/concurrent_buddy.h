@@ -0,0 +1,101 @@
+#ifndef CONCURRENT_BUDDY_H
+#define CONCURRENT_BUDDY_H
+
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+using namespace std;
+
+// Thread-safe buddy allocator. A shared buddy core keeps one lock per order,
+// and each thread keeps a small magazine of free blocks per order in front
+// of it, so most malloc/free pairs never touch the shared core. When the
+// fast path finds nothing, a slow path drains every magazine and rescans the
+// core under all order locks, so an allocation only fails when no free block
+// of the size exists.
+class ConcurrentBuddyAllocator {
+private:
+    // Almost never contended, so a test-and-set flag is enough; unlocking is
+    // a plain store.
+    class SpinLock {
+        atomic<bool> held{false};
+
+    public:
+        void lock() {
+            while (held.exchange(true, memory_order_acquire))
+                while (held.load(memory_order_relaxed))
+                    this_thread::yield();
+        }
+        void unlock() { held.store(false, memory_order_release); }
+    };
+
+    struct alignas(64) OrderList {
+        mutex lock;
+        int head = -1;
+        vector<uint64_t> free_bits;   // indexed by addr >> order
+    };
+
+    // One thread's cached blocks per order. Only the owner uses it on the
+    // fast path; the lock lets the slow path of another thread drain it.
+    struct alignas(64) Magazine {
+        SpinLock lock;
+        vector<vector<int>> blocks;
+    };
+
+    int total_size;
+    int min_order;
+    int max_order;
+    int magazine_size;
+    uint64_t serial;
+
+    unique_ptr<OrderList[]> lists;
+    // Intrusive links indexed by block number (addr >> min_order). A block is
+    // on at most one order's list at a time and its links are only touched
+    // under that order's lock.
+    vector<int> next_free;
+    vector<int> prev_free;
+    // Set by the allocating thread and swapped back to NO_ORDER by the
+    // freeing one, so a double or stray free finds NO_ORDER and is ignored.
+    static constexpr uint8_t NO_ORDER = 0xFF;
+    unique_ptr<atomic<uint8_t>[]> alloc_order;
+
+    atomic<long long> used_memory{0};
+    // Free blocks that are between two order lists while being split or
+    // merged. The slow path only trusts a failed scan when this is zero.
+    atomic<int> in_flight{0};
+
+    mutex magazines_lock;
+    vector<shared_ptr<Magazine>> magazines;   // every thread's, for draining
+
+    int size_to_order(int size) const;
+    bool is_power_of_two(int x) const;
+
+    bool test_free(int addr, int order) const;
+    void push_locked(int addr, int order);
+    void unlink_locked(int addr, int order);
+
+    int core_alloc(int order);
+    int core_alloc_batch(int order, int count, vector<int> &out);
+    void core_free(int addr, int order);
+    int slow_alloc(int order);
+    void drain_magazine(Magazine &mag);
+
+    Magazine &thread_magazine();
+
+public:
+    ConcurrentBuddyAllocator(int memory_size, int min_block_size, int magazine_blocks = 32);
+
+    int buddy_malloc(int size);
+    void buddy_free(int addr);
+
+    // Returns the calling thread's cached blocks to the shared core. Threads
+    // should call this before they exit.
+    void flush_thread_cache();
+
+    long long get_used_memory() const;
+    int get_order(int addr) const;
+};
+
+#endif
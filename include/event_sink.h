@@ -0,0 +1,160 @@
+#ifndef EVENT_SINK_H
+#define EVENT_SINK_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+using namespace std;
+
+enum SimEventType {
+    EV_INVALID_ADDRESS = 1,
+    EV_TLB_HIT,
+    EV_TLB_MISS,
+    EV_PAGE_WALK,
+    EV_PAGE_HIT,
+    EV_PAGE_FAULT,
+    EV_PAGE_EVICTION,
+    EV_PAGE_MAPPED,
+    EV_CACHE_ACCESS,
+    EV_COHERENT_ACCESS,
+    EV_TYPE_COUNT
+};
+
+// Where the data for a coherent access came from; the level of a
+// COHERENT_ACCESS event.
+enum CoherenceSource {
+    SRC_L1,         // private L1 hit with sufficient permission
+    SRC_UPGRADE,    // L1 hit on a shared line, needed write permission
+    SRC_PEER,       // another core's dirty copy supplied the line
+    SRC_LLC,
+    SRC_MEMORY
+};
+
+enum SimEventFlag {
+    EVF_DIRTY = 1,      // evicted page had to be written back
+    EVF_WRITE = 2       // page hits, faults and mappings, and cache accesses
+};
+
+// One per-access event, 24 bytes so the binary log can write it as is.
+//
+//   type                pid   addr              level               frame     value
+//   INVALID_ADDRESS     pid   virtual address
+//   TLB_HIT             pid   page              level that hit
+//   TLB_MISS            pid   page              levels probed
+//   PAGE_WALK           pid   page              depth                         cycles
+//   PAGE_HIT/MAPPED     pid   page                                  frame
+//   PAGE_FAULT          pid   page
+//   PAGE_EVICTION       pid   page                                  frame
+//   CACHE_ACCESS        pid   physical address  level that hit      levels    cycles
+//   COHERENT_ACCESS     core  physical address  CoherenceSource     peer      copies invalidated
+//
+// Levels count from 0 (L1); a cache access with level == levels went to
+// memory. `state` is the line's MESI/MOESI state after a coherent access.
+struct SimEvent {
+    uint8_t type;
+    uint8_t level;
+    uint8_t flags;
+    char state;
+    int32_t pid;
+    int32_t frame;
+    int32_t value;
+    int64_t addr;
+};
+
+// Receives every per-access event from the VM and the cache lookups. The
+// text sink prints the usual trace; the others keep long runs off iostream.
+class EventSink {
+public:
+    virtual ~EventSink() {}
+
+    virtual const char *name() const = 0;
+    virtual void emit(const SimEvent &e) = 0;
+    virtual void flush() {}
+
+    // Extra lines for the statistics report, if the sink keeps any.
+    virtual void print_summary() const {}
+};
+
+// The trace the simulator has always printed on cout. Page walks are only
+// printed when verbose; otherwise they show up in the report totals.
+class TextEventSink : public EventSink {
+    bool verbose;
+
+public:
+    explicit TextEventSink(bool verbose = false) : verbose(verbose) {}
+
+    const char *name() const override { return verbose ? "Verbose Text" : "Text"; }
+    void emit(const SimEvent &e) override;
+};
+
+class NullEventSink : public EventSink {
+public:
+    const char *name() const override { return "None"; }
+    void emit(const SimEvent &) override {}
+};
+
+// Counts events by type, and TLB and cache hits by level.
+class CounterEventSink : public EventSink {
+    static const int MAX_LEVELS = 8;
+
+    long long counts[EV_TYPE_COUNT] = {};
+    long long by_level[EV_TYPE_COUNT][MAX_LEVELS + 1] = {};
+
+public:
+    const char *name() const override { return "Counters"; }
+    void emit(const SimEvent &e) override;
+    void print_summary() const override;
+
+    long long count(SimEventType type) const { return counts[type]; }
+};
+
+// Appends raw SimEvent records to a file, buffered. The file starts with
+// the 8-byte magic "MSIMEVT1" and a uint32 record size; records follow in
+// host byte order.
+class BinaryEventLog : public EventSink {
+    static const size_t BUFFER_EVENTS = 4096;
+
+    string path;
+    ofstream out;
+    vector<SimEvent> buffer;
+    long long written = 0;
+
+public:
+    explicit BinaryEventLog(const string &path);
+    ~BinaryEventLog() override { flush(); }
+
+    bool is_open() const { return (bool)out; }
+
+    const char *name() const override { return "Binary Log"; }
+    void emit(const SimEvent &e) override {
+        buffer.push_back(e);
+        if (buffer.size() == BUFFER_EVENTS)
+            flush();
+    }
+    void flush() override;
+    void print_summary() const override;
+};
+
+// Where events go; the text sink until something else is selected.
+extern EventSink *event_sink;
+
+inline void emit_event(SimEventType type, int pid, long long addr, int level = 0,
+                       int frame = 0, int value = 0, int flags = 0, char state = 0) {
+    SimEvent e;
+    e.type = (uint8_t)type;
+    e.level = (uint8_t)level;
+    e.flags = (uint8_t)flags;
+    e.state = state;
+    e.pid = pid;
+    e.frame = frame;
+    e.value = value;
+    e.addr = addr;
+    event_sink->emit(e);
+}
+
+// "text", "verbose", "none", "counters" or "binary:<path>"; nullptr if unknown or the
+// log cannot be opened.
+EventSink *make_event_sink(const string &spec);
+
+#endif
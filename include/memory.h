@@ -1,8 +1,9 @@
 #ifndef MEMORY_H
 #define MEMORY_H
 
-#include <list>
 #include <vector>
+#include <iterator>
+#include <cstddef>
 #include <string>
 #include <iostream>
 #include <unordered_map>
@@ -11,7 +12,6 @@ using namespace std;
 extern int total_memory_size;
 
 extern int next_block_id;
-extern unordered_map<int,int> buddy_ids;  
 
 struct Block {
     int start;
@@ -23,18 +23,89 @@ struct Block {
 int get_block_id(int start_address);
 int get_block_start_by_id(int id);
 
-extern list<Block> memory_blocks;
+// Address-ordered sequence of blocks backed by a contiguous slot pool.
+// Blocks live in one vector and are chained through parallel prev/next
+// index arrays, so splits and merges reuse slots instead of allocating
+// list nodes, and iterators (slot numbers) stay valid across inserts.
+class BlockList {
+public:
+    class iterator {
+    public:
+        typedef bidirectional_iterator_tag iterator_category;
+        typedef Block value_type;
+        typedef ptrdiff_t difference_type;
+        typedef Block* pointer;
+        typedef Block& reference;
+
+        iterator() : owner(nullptr), pos(-1) {}
+        iterator(BlockList *o, int p) : owner(o), pos(p) {}
+
+        Block &operator*() const { return owner->blocks[pos]; }
+        Block *operator->() const { return &owner->blocks[pos]; }
+
+        iterator &operator++() { pos = owner->next_slot[pos]; return *this; }
+        iterator &operator--() {
+            pos = (pos == -1) ? owner->tail : owner->prev_slot[pos];
+            return *this;
+        }
+        iterator operator++(int) { iterator t = *this; ++*this; return t; }
+        iterator operator--(int) { iterator t = *this; --*this; return t; }
+
+        bool operator==(const iterator &o) const { return pos == o.pos; }
+        bool operator!=(const iterator &o) const { return pos != o.pos; }
+
+        int slot() const { return pos; }
+
+    private:
+        BlockList *owner;
+        int pos;
+    };
+
+    iterator begin() { return iterator(this, head); }
+    iterator end() { return iterator(this, -1); }
+
+    iterator insert(iterator before, const Block &b);
+    iterator erase(iterator it);
+    void push_back(const Block &b) { insert(end(), b); }
+    void clear();
+
+    int size() const { return count; }
+
+private:
+    vector<Block> blocks;
+    vector<int> next_slot;
+    vector<int> prev_slot;
+    vector<int> unused_slots;
+    int head = -1;
+    int tail = -1;
+    int count = 0;
+};
+
+extern BlockList memory_blocks;
 
 void init_memory(int total_size);
 void dump_memory();
 
+enum LinearFit {
+    FIT_FIRST = 1,
+    FIT_BEST,
+    FIT_WORST,
+    FIT_TLSF
+};
+
 int malloc_first_fit(int size);
 int malloc_best_fit(int size);
 int malloc_worst_fit(int size);
+int malloc_tlsf(int size);
 void free_block(int start_address);
 
+int malloc_linear_n(LinearFit fit, int size, int count, vector<int> &out);
+void free_block_n(vector<int> addrs);
+
 int internal_fragmentation();
 int external_fragmentation();
+int free_memory();
+int largest_free_block();
 double memory_utilization();
 
 extern int total_alloc_requests;
@@ -0,0 +1,191 @@
+#ifndef PAGE_REPLACEMENT_H
+#define PAGE_REPLACEMENT_H
+
+#include <vector>
+#include <list>
+#include <set>
+#include <deque>
+#include <unordered_map>
+using namespace std;
+
+enum PageReplacementPolicy {
+    PR_LRU = 1,
+    PR_FIFO,
+    PR_CLOCK,
+    PR_ENHANCED_CLOCK,
+    PR_AGING,
+    PR_ARC,
+    PR_OPT
+};
+
+// Chooses which resident page to evict when every frame is in use. The VM
+// keeps the frame table and reports each event; the policy keeps its own
+// per-frame state. `page` identifies a (pid, page) pair for policies that
+// remember pages after they leave memory.
+class PageReplacer {
+public:
+    virtual ~PageReplacer() {}
+
+    virtual const char *name() const = 0;
+    virtual void reset(int frames) = 0;
+
+    virtual void on_load(int frame, long long page, bool write) = 0;   // page fault filled frame
+    virtual void on_access(int frame, long long page, bool write) = 0; // page hit
+    virtual void on_free(int frame) = 0;                               // frame given back
+
+    // Only called while every frame is resident; `page` is the one coming in.
+    virtual int victim(long long page) = 0;
+};
+
+// Least recently used, with an intrusive list over the frames.
+class LruReplacer : public PageReplacer {
+    vector<int> prev, next;
+    int head = -1, tail = -1;
+
+    void unlink(int f);
+    void push_front(int f);
+
+public:
+    const char *name() const override { return "LRU"; }
+    void reset(int frames) override;
+    void on_load(int frame, long long, bool) override { push_front(frame); }
+    void on_access(int frame, long long, bool) override;
+    void on_free(int frame) override { unlink(frame); }
+    int victim(long long) override { return tail; }
+};
+
+// Evicts pages in the order they were loaded.
+class FifoReplacer : public PageReplacer {
+    deque<pair<int, long long>> order;  // (frame, load stamp)
+    vector<long long> loaded;           // current stamp per frame, -1 if free
+    long long stamp = 0;
+
+public:
+    const char *name() const override { return "FIFO"; }
+    void reset(int frames) override;
+    void on_load(int frame, long long, bool) override;
+    void on_access(int, long long, bool) override {}
+    void on_free(int frame) override { loaded[frame] = -1; }
+    int victim(long long) override;
+};
+
+// Second chance: a hand sweeps the frames, clearing reference bits, and
+// takes the first frame whose bit is already clear.
+class ClockReplacer : public PageReplacer {
+    vector<char> referenced;
+    int hand = 0;
+
+public:
+    const char *name() const override { return "Clock"; }
+    void reset(int frames) override;
+    void on_load(int frame, long long, bool) override { referenced[frame] = 1; }
+    void on_access(int frame, long long, bool) override { referenced[frame] = 1; }
+    void on_free(int frame) override { referenced[frame] = 0; }
+    int victim(long long) override;
+};
+
+// Enhanced second chance: prefers (unreferenced, clean) pages, then
+// (unreferenced, dirty), clearing reference bits on the second sweep, so
+// clean pages that avoid a disk write go first.
+class EnhancedClockReplacer : public PageReplacer {
+    vector<char> referenced, dirty;
+    int hand = 0;
+
+public:
+    const char *name() const override { return "Enhanced Clock"; }
+    void reset(int frames) override;
+    void on_load(int frame, long long, bool write) override;
+    void on_access(int frame, long long, bool write) override;
+    void on_free(int frame) override { referenced[frame] = dirty[frame] = 0; }
+    int victim(long long) override;
+};
+
+// LFU with aging: each frame counts its references, and every
+// AGING_PERIOD x frames accesses all counts are halved so old popularity
+// fades. Ties go to the least recently used frame.
+class AgingReplacer : public PageReplacer {
+    static const int AGING_PERIOD = 8;
+
+    vector<long long> count, last_use;
+    set<pair<pair<long long, long long>, int>> order;  // ((count, last use), frame)
+    long long clock = 0;
+    long long next_aging = 0;
+    int frames = 0;
+
+    void touch(int frame, bool fresh);
+    void age();
+
+public:
+    const char *name() const override { return "LFU (aging)"; }
+    void reset(int frames) override;
+    void on_load(int frame, long long, bool) override { touch(frame, true); }
+    void on_access(int frame, long long, bool) override { touch(frame, false); }
+    void on_free(int frame) override;
+    int victim(long long) override;
+};
+
+// Adaptive Replacement Cache (Megiddo & Modha). T1 holds pages seen once
+// recently and T2 pages seen at least twice; B1 and B2 remember pages
+// recently evicted from each. Misses that hit a ghost list move the target
+// size p of T1 towards the list that would have kept the page.
+class ArcReplacer : public PageReplacer {
+    enum Where { T1, T2, B1, B2 };
+    struct Entry {
+        Where where;
+        list<long long>::iterator pos;
+    };
+
+    int capacity = 0;
+    int p = 0;
+    list<long long> lists[4];       // most recent at the front
+    unordered_map<long long, Entry> entries;
+    vector<long long> page_of;      // resident page per frame
+    unordered_map<long long, int> frame_of;
+    bool adapted = false;           // victim() already ran the miss logic
+    bool discard_t1 = false;        // the next replacement drops T1's LRU page
+
+    void move_to(long long page, Where where);
+    void forget_lru(Where where);
+    void adapt(long long page);
+    int replace(long long page);
+
+public:
+    const char *name() const override { return "ARC"; }
+    void reset(int frames) override;
+    void on_load(int frame, long long page, bool) override;
+    void on_access(int frame, long long page, bool) override;
+    void on_free(int frame) override;
+    int victim(long long page) override;
+};
+
+// Belady's optimal policy for a known reference string: evict the page
+// whose next use is furthest away. next_use[i] is the index of the next
+// reference to the page of reference i (see opt_next_use); every call to
+// on_load/on_access consumes one reference.
+class OptReplacer : public PageReplacer {
+    vector<int> next_use;
+    size_t t = 0;
+    vector<int> due;                // next use of the page in each frame
+    set<pair<int, int>> order;      // (next use, frame)
+
+    void set_due(int frame);
+
+public:
+    explicit OptReplacer(const vector<int> &next_use) : next_use(next_use) {}
+
+    const char *name() const override { return "OPT"; }
+    void reset(int frames) override;
+    void on_load(int frame, long long, bool) override { set_due(frame); }
+    void on_access(int frame, long long, bool) override { set_due(frame); }
+    void on_free(int frame) override;
+    int victim(long long) override;
+};
+
+// One backward pass over a reference string: for each reference, the
+// index of the next reference to the same page, or refs.size() if none.
+vector<int> opt_next_use(const vector<long long> &refs);
+
+// All policies except OPT, which needs the whole reference string.
+PageReplacer *make_page_replacer(PageReplacementPolicy policy);
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <vector>
+using namespace std;
+
+enum PrefetchKind {
+    PF_NONE = 0,
+    PF_NEXT_LINE,
+    PF_STRIDE,
+    PF_STREAM
+};
+
+// What a demand access found at the prefetcher's cache level.
+enum PrefetchOutcome {
+    PF_HIT,             // ordinary hit
+    PF_MISS,
+    PF_PREFETCH_HIT     // first demand use of a prefetched block
+};
+
+// A prefetcher watches the demand accesses that reach its cache level and
+// proposes blocks to bring in. Addresses are block-aligned for that level.
+// The hierarchy does the fills and keeps the accuracy/coverage/timeliness
+// counters, so a prefetcher only holds its own training state.
+class Prefetcher {
+public:
+    virtual ~Prefetcher() {}
+
+    virtual const char *name() const = 0;
+    virtual void observe(int block_addr, PrefetchOutcome outcome, vector<int> &out) = 0;
+
+    // Stream buffers keep prefetched blocks outside the cache.
+    virtual bool uses_buffer() const { return false; }
+};
+
+// Tagged next-line: a miss, or the first use of a prefetched block, fetches
+// the next `degree` blocks.
+class NextLinePrefetcher : public Prefetcher {
+    int block_size;
+    int degree;
+
+public:
+    NextLinePrefetcher(int block_size, int degree = 1) : block_size(block_size), degree(degree) {}
+
+    const char *name() const override { return "NextLine"; }
+    void observe(int block_addr, PrefetchOutcome outcome, vector<int> &out) override;
+};
+
+// IP-less stride detection. Accesses are grouped by 4KB region; a region
+// whose last two deltas match has a confirmed stride, and each further
+// access prefetches `degree` blocks ahead along it.
+class StridePrefetcher : public Prefetcher {
+    struct Region {
+        int region = -1;
+        int last_block = 0;
+        int stride = 0;
+        int confidence = 0;
+        long long last_use = 0;
+    };
+
+    static const int REGION_BITS = 12;
+    static const int TABLE_SIZE = 16;
+
+    int block_size;
+    int degree;
+    vector<Region> table;
+    long long clock = 0;
+
+public:
+    StridePrefetcher(int block_size, int degree = 2)
+        : block_size(block_size), degree(degree), table(TABLE_SIZE) {}
+
+    const char *name() const override { return "Stride"; }
+    void observe(int block_addr, PrefetchOutcome outcome, vector<int> &out) override;
+};
+
+// Sequential stream buffers (Jouppi). A miss starts a stream that runs
+// `depth` blocks ahead of it; each use of a streamed block extends that
+// stream by one. Streams are replaced LRU.
+class StreamBufferPrefetcher : public Prefetcher {
+    struct Stream {
+        int next = -1;          // next block the stream will fetch
+        long long last_use = 0;
+    };
+
+    int block_size;
+    int depth;
+    vector<Stream> streams;
+    long long clock = 0;
+
+public:
+    StreamBufferPrefetcher(int block_size, int stream_count = 4, int depth = 4)
+        : block_size(block_size), depth(depth), streams(stream_count) {}
+
+    const char *name() const override { return "StreamBuffer"; }
+    void observe(int block_addr, PrefetchOutcome outcome, vector<int> &out) override;
+    bool uses_buffer() const override { return true; }
+};
+
+Prefetcher *make_prefetcher(PrefetchKind kind, int block_size);
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef SET_STATS_H
+#define SET_STATS_H
+
+#include <vector>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <iosfwd>
+
+// Per-set access and miss counters for one cache, with every miss put in
+// one of the three C's:
+//
+//   compulsory  first reference to the block
+//   capacity    a fully associative LRU cache of the same size misses too
+//   conflict    only the set mapping made it miss
+//
+// The fully associative cache is a shadow that sees the same accesses as
+// the real one. Sets with many conflict misses are the ones that would gain
+// from more ways or a victim cache.
+class SetStats {
+public:
+    struct Counts {
+        long long accesses = 0;
+        long long misses = 0;
+        long long compulsory = 0;
+        long long capacity = 0;
+        long long conflict = 0;
+    };
+
+private:
+    std::vector<Counts> sets;
+    Counts total;
+
+    size_t capacity_blocks;
+    std::list<int> shadow;      // most recent first
+    std::unordered_map<int, std::list<int>::iterator> shadow_pos;
+    std::unordered_set<int> seen;
+
+    // Touches block in the shadow; returns whether it was there.
+    bool shadow_access(int block) {
+        auto it = shadow_pos.find(block);
+        if (it != shadow_pos.end()) {
+            shadow.splice(shadow.begin(), shadow, it->second);
+            return true;
+        }
+        shadow.push_front(block);
+        shadow_pos[block] = shadow.begin();
+        if (shadow.size() > capacity_blocks) {
+            shadow_pos.erase(shadow.back());
+            shadow.pop_back();
+        }
+        return false;
+    }
+
+public:
+    SetStats(int num_sets, int num_blocks) : sets(num_sets), capacity_blocks(num_blocks) {}
+
+    // block is any number unique to the block, e.g. its base address.
+    void record(int set, int block, bool hit) {
+        bool shadow_hit = shadow_access(block);
+        bool first = seen.insert(block).second;
+
+        Counts &c = sets[set];
+        c.accesses++;
+        total.accesses++;
+        if (hit)
+            return;
+
+        c.misses++;
+        total.misses++;
+        if (first) {
+            c.compulsory++;
+            total.compulsory++;
+        } else if (!shadow_hit) {
+            c.capacity++;
+            total.capacity++;
+        } else {
+            c.conflict++;
+            total.conflict++;
+        }
+    }
+
+    int set_count() const { return (int)sets.size(); }
+    const Counts &for_set(int set) const { return sets[set]; }
+    const Counts &totals() const { return total; }
+
+    // The sets with the most conflict misses, most first.
+    std::vector<int> hottest_sets(int count) const;
+
+    // "<name> Compulsory/Capacity/Conflict Misses" and the hottest sets.
+    void print_summary(const std::string &name) const;
+
+    // One CSV row per set: set,accesses,misses,compulsory,capacity,conflict.
+    // Rows start with `label,` when a label is given.
+    void write_histogram(std::ostream &out, const std::string &label = "") const;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef STACK_DISTANCE_H
+#define STACK_DISTANCE_H
+
+#include <vector>
+#include <cstdint>
+using namespace std;
+
+// LRU stack distances (Mattson). Each access is stamped with a position and
+// a Fenwick tree marks the position of every key's latest access, so the
+// number of distinct keys touched since a key's previous access is a prefix
+// sum: O(log n) per access. Positions are compacted when they run out, which
+// keeps the tree at most twice the number of distinct keys.
+//
+// Keys are small non-negative ids. Stacks whose key sets are disjoint, like
+// the sets of one cache, may share a position table (key -> position, -1 if
+// unseen) instead of each keeping its own.
+class StackDistance {
+private:
+    vector<int> tree;                   // Fenwick tree over positions, 1-based
+    vector<uint8_t> live;               // live[p]: position p is a key's latest access
+    vector<int> key_at;                 // key stamped at each position
+    vector<int> own_position;
+    vector<int> *position;
+    int next_pos = 1;
+    int live_count = 0;
+
+    void add(int p, int delta);
+    int prefix(int p) const;
+    void compact();
+
+public:
+    explicit StackDistance(vector<int> *shared_position = nullptr)
+        : position(shared_position ? shared_position : &own_position) {}
+    StackDistance(const StackDistance &) = delete;
+    StackDistance &operator=(const StackDistance &) = delete;
+
+    // Returns how many distinct keys were accessed since key's previous
+    // access (0 for an immediate re-reference), or -1 on first access.
+    int access(int key);
+
+    int distinct() const { return live_count; }
+};
+
+// Stack distance histogram of one LRU stack. hist[d] counts accesses at
+// distance d; an LRU cache holding n blocks hits exactly the accesses with
+// d < n.
+struct StackProfile {
+    long long accesses = 0;
+    long long cold = 0;
+    vector<long long> hist;
+
+    void record(int distance);
+    long long hits(int blocks) const;
+    double hit_ratio(int blocks) const;
+};
+
+// One-pass profile of a fully associative LRU cache: the returned histogram
+// gives the hit ratio of every capacity at this block size.
+StackProfile profile_fully_associative(const vector<int> &trace, int block_size);
+
+// One-pass profile of set-associative LRU caches with 2^k sets for every
+// k in [0, max_sets_log2]. profiles[k] holds the per-set stack distances,
+// so a cache with 2^k sets and N ways hits the accesses with d < N.
+// Set counts above max_tracked_sets are set-sampled: only every
+// (sets / max_tracked_sets)-th set is simulated, and the ratios are
+// estimates over those sets.
+struct SetAssocProfile {
+    int block_size;
+    int max_tracked_sets;
+    vector<StackProfile> profiles;
+
+    bool sampled(int sets_log2) const { return (1 << sets_log2) > max_tracked_sets; }
+};
+
+SetAssocProfile profile_set_associative(const vector<int> &trace, int block_size,
+                                        int max_sets_log2, int max_tracked_sets = 1024);
+
+#endif
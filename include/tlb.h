@@ -0,0 +1,51 @@
+#ifndef TLB_H
+#define TLB_H
+
+#include <vector>
+#include <string>
+using namespace std;
+
+struct TlbEntry {
+    bool valid = false;
+    bool dirty = false;     // the PTE is already dirty, so writes skip the walk
+    int asid = 0;
+    long long page = 0;
+    int frame = 0;
+    long long last_used = 0;
+};
+
+// One set-associative TLB level with LRU replacement. Entries are tagged
+// with the address space (PID) as well as the virtual page, so processes
+// can share the TLB without a flush on every switch.
+class Tlb {
+    int num_sets;
+    int ways;
+    int latency;
+    vector<TlbEntry> entries;   // num_sets x ways
+    long long clock = 0;
+    long long hits = 0;
+    long long misses = 0;
+
+    TlbEntry *set_of(long long page) { return &entries[((unsigned long long)page % num_sets) * ways]; }
+
+public:
+    Tlb(int num_entries, int ways, int latency);
+
+    // Returns the entry and makes it most recent, or nullptr on a miss.
+    TlbEntry *lookup(int asid, long long page);
+    void insert(int asid, long long page, int frame, bool dirty);
+
+    void invalidate(int asid, long long page);
+    void flush_asid(int asid);
+    void flush();
+    void reset_stats() { hits = misses = 0; }
+    void print_stats(const string &name) const;
+
+    int get_entries() const { return (int)entries.size(); }
+    int get_ways() const { return ways; }
+    int get_latency() const { return latency; }
+    long long get_hits() const { return hits; }
+    long long get_misses() const { return misses; }
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <vector>
+#include <string>
+#include "cache.h"
+using namespace std;
+
+// Address traces for the offline cache tools. A trace file holds one
+// address per line, in decimal or 0x-prefixed hex; blank lines and lines
+// starting with '#' are skipped.
+bool load_trace(const string &path, vector<int> &addresses);
+
+// Multi-core traces hold "<core> <R|W> <address>" per line, with the same
+// address and comment rules. Addresses here are 64-bit, so paging traces
+// can use the whole virtual address space; the cache tools check that
+// they fit their 32-bit physical addresses.
+struct CoreAccess {
+    int core;
+    AccessType type;
+    long long address;
+};
+
+bool load_core_trace(const string &path, vector<CoreAccess> &accesses);
+
+#endif
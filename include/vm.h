@@ -3,27 +3,61 @@
 
 #include <vector>
 #include <unordered_map>
+#include "page_replacement.h"
+#include "tlb.h"
+#include "event_sink.h"
 using namespace std;
 
 extern int disk_penalty;
 
+// Virtual addresses are 64-bit, but one process's space is capped at
+// 48 bits, as on x86-64.
+const long long MAX_VIRTUAL_SIZE = 1LL << 48;
+
 struct PageTableEntry {
     bool valid;
+    bool dirty;         // written since it was loaded; eviction costs a disk write
     int frame;
     int last_used;
 };
 
 void reset_vm_system(int physical_size, int page_size);
 
-void init_vm(int pid, int virtual_size);
-int vm_access(int pid, int vaddr);
+// False if the size is outside 0..MAX_VIRTUAL_SIZE; the caller reports it.
+bool init_vm(int pid, long long virtual_size);
+int vm_access(int pid, long long vaddr, bool write = false);
 void dump_page_table(int pid);
 
+// Replaces the page replacement policy (LRU by default); the VM owns it.
+// Pages already in memory are handed to the new policy.
+void set_page_replacement(PageReplacer *policy);
+const char *page_replacement_name();
+
+// TLB levels in front of the page tables, L1 first; an empty list turns
+// translation caching off. Without ASIDs, switching to another PID
+// flushes every level.
+void configure_tlb(const vector<Tlb> &levels, bool use_asids);
+int tlb_level_count();
+const Tlb &tlb_level(int k);
+bool tlb_uses_asids();
+long long get_tlb_flushes();
+long long get_translation_cycles();     // TLB lookup latency charged so far
+
+// Each page-walk step reads one PTE at a physical address above RAM. The
+// handler charges that read, e.g. through the cache hierarchy, and returns
+// its cycles. Walks are free until a handler is set.
+void set_page_walk_handler(int (*handler)(int pid, int pte_addr));
+long long get_page_walks();
+long long get_walk_cycles();
+long long get_page_table_bytes();   // host memory held by page table nodes
+
 bool any_vm_initialized();
 vector<int> get_initialized_pids();
 
 int get_page_hits();
 int get_page_faults();
+int get_page_writebacks();
+long long get_disk_cycles();    // fault reads plus dirty page writes
 
 int get_used_frames(int pid);
 int get_total_frames();
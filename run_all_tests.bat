@@ -14,4 +14,19 @@ memsim.exe < test\cache.txt  >> output\all_tests.txt
 echo ===== VM TEST =====     >> output\all_tests.txt
 memsim.exe < test\vm.txt     >> output\all_tests.txt
 
+echo ===== TLSF TEST ===== >> output\all_tests.txt
+memsim.exe < test\tlsf.txt >> output\all_tests.txt
+
+echo ===== BULK TEST ===== >> output\all_tests.txt
+memsim.exe < test\bulk.txt >> output\all_tests.txt
+
+echo ===== LAZY BUDDY TEST ===== >> output\all_tests.txt
+memsim.exe < test\lazy_buddy.txt >> output\all_tests.txt
+
+echo ===== CACHE LEVELS TEST ===== >> output\all_tests.txt
+memsim.exe < test\cache_levels.txt >> output\all_tests.txt
+
+echo ===== TLB TEST ===== >> output\all_tests.txt
+memsim.exe < test\tlb.txt >> output\all_tests.txt
+
 echo All tests completed.
@@ -15,4 +15,19 @@ echo "===== CACHE TEST ====="  >> $OUT
 echo "===== VM TEST ====="     >> $OUT
 ./memsim.exe < test/vm.txt     >> $OUT
 
+echo "===== TLSF TEST =====" >> $OUT
+./memsim.exe < test/tlsf.txt >> $OUT
+
+echo "===== BULK TEST =====" >> $OUT
+./memsim.exe < test/bulk.txt >> $OUT
+
+echo "===== LAZY BUDDY TEST =====" >> $OUT
+./memsim.exe < test/lazy_buddy.txt >> $OUT
+
+echo "===== CACHE LEVELS TEST =====" >> $OUT
+./memsim.exe < test/cache_levels.txt >> $OUT
+
+echo "===== TLB TEST =====" >> $OUT
+./memsim.exe < test/tlb.txt >> $OUT
+
 echo "All tests completed."
@@ -29,8 +29,74 @@ BuddyAllocator::BuddyAllocator(int memory_size, int min_block_size) {
     min_order = size_to_order(min_block_size);
     max_order = size_to_order(memory_size);
 
-    free_list.resize(max_order + 1);
-    free_list[max_order].push_back(0);
+    int blocks = max(1, total_size >> min_order);
+    free_head.assign(max_order + 1, -1);
+    free_tail.assign(max_order + 1, -1);
+    next_free.assign(blocks, -1);
+    prev_free.assign(blocks, -1);
+    free_order.assign(blocks, -1);
+    alloc_order.assign(blocks, NO_ORDER);
+    requested_size.assign(blocks, 0);
+    block_id.assign(blocks, 0);
+    lazy_free.assign(blocks, 0);
+    lazy_count.assign(max_order + 1, 0);
+
+    push_free(0, max_order);
+}
+
+void BuddyAllocator::push_free(int addr, int order) {
+    int b = addr >> min_order;
+    free_order[b] = order;
+    next_free[b] = -1;
+    prev_free[b] = free_tail[order];
+
+    if (free_tail[order] != -1)
+        next_free[free_tail[order]] = b;
+    else
+        free_head[order] = b;
+    free_tail[order] = b;
+}
+
+void BuddyAllocator::unlink_free(int addr, int order) {
+    int b = addr >> min_order;
+    free_order[b] = -1;
+    clear_lazy(addr, order);
+
+    if (prev_free[b] != -1)
+        next_free[prev_free[b]] = next_free[b];
+    else
+        free_head[order] = next_free[b];
+
+    if (next_free[b] != -1)
+        prev_free[next_free[b]] = prev_free[b];
+    else
+        free_tail[order] = prev_free[b];
+}
+
+void BuddyAllocator::clear_lazy(int addr, int order) {
+    int b = addr >> min_order;
+    if (lazy_free[b]) {
+        lazy_free[b] = 0;
+        lazy_count[order]--;
+        lazy_blocks--;
+    }
+}
+
+int BuddyAllocator::pop_free(int order) {
+    int addr = free_head[order] << min_order;
+    unlink_free(addr, order);
+    return addr;
+}
+
+void BuddyAllocator::set_lazy(bool enabled, int watermark) {
+    if (lazy && !enabled)
+        coalesce_all();
+    lazy = enabled;
+    lazy_watermark = watermark;
+}
+
+bool BuddyAllocator::is_lazy() const {
+    return lazy;
 }
 
 int BuddyAllocator::buddy_malloc(int size) {
@@ -39,56 +105,207 @@ int BuddyAllocator::buddy_malloc(int size) {
         req_order = min_order;
 
     int cur_order = req_order;
-    while (cur_order <= max_order && free_list[cur_order].empty())
+    while (cur_order <= max_order && free_head[cur_order] == -1)
         cur_order++;
 
-    if (cur_order > max_order)
-        return -1;
+    if (cur_order > max_order) {
+        if (lazy_blocks == 0)
+            return -1;
+        coalesce_all();
+        return buddy_malloc(size);
+    }
 
-    int addr = free_list[cur_order].front();
-    free_list[cur_order].pop_front();
+    int addr = pop_free(cur_order);
 
     while (cur_order > req_order) {
         cur_order--;
         int buddy = addr + (1 << cur_order);
-        free_list[cur_order].push_back(buddy);
+        push_free(buddy, cur_order);
+        split_count++;
     }
 
-    allocated_order[addr] = req_order;
-    requested_size[addr] = size;
-    used_memory += (1 << req_order);
+    record_allocation(addr, req_order, size);
+    return addr;
+}
 
-    buddy_ids[addr] = next_block_id++;
+void BuddyAllocator::record_allocation(int addr, int order, int size) {
+    int b = addr >> min_order;
+    alloc_order[b] = order;
+    requested_size[b] = size;
+    used_memory += (1 << order);
+    internal_frag += (1 << order) - size;
 
-    return addr;
+    block_id[b] = next_block_id;
+    id_to_addr[next_block_id++] = addr;
+}
+
+int BuddyAllocator::release_allocation(int addr) {
+    if (addr < 0 || addr >= total_size || (addr & ((1 << min_order) - 1)))
+        return -1;
+
+    int b = addr >> min_order;
+    if (alloc_order[b] == NO_ORDER)
+        return -1;
+
+    int order = alloc_order[b];
+    used_memory -= (1 << order);
+    internal_frag -= (1 << order) - (int)requested_size[b];
+    alloc_order[b] = NO_ORDER;
+    id_to_addr.erase(block_id[b]);
+    block_id[b] = 0;
+    return order;
 }
 
 void BuddyAllocator::buddy_free(int addr) {
-    if (allocated_order.find(addr) == allocated_order.end())
+    int order = release_allocation(addr);
+    if (order != -1)
+        release_block(addr, order);
+}
+
+// In lazy mode a freed block stays uncoalesced on its own order's list until
+// that order holds more than lazy_watermark such blocks; beyond the watermark
+// frees coalesce eagerly again.
+void BuddyAllocator::release_block(int addr, int order) {
+    if (!lazy || order == max_order || lazy_count[order] >= lazy_watermark) {
+        coalesce(addr, order);
         return;
+    }
 
-    int order = allocated_order[addr];
-    used_memory -= (1 << order);
-    allocated_order.erase(addr);
-    requested_size.erase(addr);
-    buddy_ids.erase(addr);
+    push_free(addr, order);
+    lazy_free[addr >> min_order] = 1;
+    lazy_count[order]++;
+    lazy_blocks++;
+}
 
+// Merges every pair of free buddies, lowest order first, so blocks merged at
+// one order are considered again at the next. Afterwards no block is left
+// marked as deferred.
+void BuddyAllocator::coalesce_all() {
+    for (int order = min_order; order < max_order; order++) {
+        vector<int> candidates;
+        for (int b = free_head[order]; b != -1; b = next_free[b])
+            candidates.push_back(b << min_order);
+
+        for (int addr : candidates) {
+            int buddy = addr ^ (1 << order);
+            if (free_order[addr >> min_order] != order)
+                continue;
+            if (free_order[buddy >> min_order] != order) {
+                clear_lazy(addr, order);
+                continue;
+            }
+
+            unlink_free(addr, order);
+            unlink_free(buddy, order);
+            push_free(min(addr, buddy), order + 1);
+            merge_count++;
+        }
+    }
+}
+
+void BuddyAllocator::coalesce(int addr, int order) {
     while (order < max_order) {
         int block_size = 1 << order;
         int buddy = addr ^ block_size;
 
-        auto &lst = free_list[order];
-        auto it = find(lst.begin(), lst.end(), buddy);
-
-        if (it == lst.end())
+        if (free_order[buddy >> min_order] != order)
             break;
 
-        lst.erase(it);
+        unlink_free(buddy, order);
         addr = min(addr, buddy);
         order++;
+        merge_count++;
+    }
+
+    push_free(addr, order);
+}
+
+// Serves up to `count` requests of `size` bytes. Each round takes one free
+// block big enough for the remaining requests (or the largest one available),
+// splits it down once and hands out its leading units; the unused tail goes
+// back to the free lists as maximal aligned blocks.
+int BuddyAllocator::buddy_malloc_n(int size, int count, vector<int> &out) {
+    int req_order = size_to_order(size);
+    if (req_order < min_order)
+        req_order = min_order;
+    if (req_order > max_order)
+        return 0;
+
+    int served = 0;
+    while (served < count) {
+        int remaining = count - served;
+        int want = req_order + size_to_order(remaining);
+        if (want > max_order)
+            want = max_order;
+
+        int cur_order = want;
+        while (cur_order <= max_order && free_head[cur_order] == -1)
+            cur_order++;
+        if (cur_order > max_order) {
+            cur_order = want - 1;
+            while (cur_order >= req_order && free_head[cur_order] == -1)
+                cur_order--;
+            if (cur_order < req_order) {
+                if (lazy_blocks == 0)
+                    break;
+                coalesce_all();
+                continue;
+            }
+        }
+
+        int addr = pop_free(cur_order);
+
+        while (cur_order > want) {
+            cur_order--;
+            push_free(addr + (1 << cur_order), cur_order);
+            split_count++;
+        }
+
+        int units = 1 << (cur_order - req_order);
+        int used = min(units, remaining);
+        for (int i = 0; i < used; i++) {
+            int unit_addr = addr + (i << req_order);
+            record_allocation(unit_addr, req_order, size);
+            out.push_back(unit_addr);
+        }
+        served += used;
+
+        // Cutting the block into `pieces` parts takes pieces - 1 splits.
+        int pieces = used;
+        int pos = used;
+        while (pos < units) {
+            int o = 0;
+            while (!(pos & (1 << o)) && pos + (2 << o) <= units)
+                o++;
+            push_free(addr + (pos << req_order), req_order + o);
+            pos += 1 << o;
+            pieces++;
+        }
+        split_count += pieces - 1;
     }
 
-    free_list[order].push_back(addr);
+    return served;
+}
+
+// Frees a batch of blocks in address order, so the coalescing walk moves
+// through the metadata arrays in one forward pass.
+void BuddyAllocator::buddy_free_n(vector<int> addrs) {
+    if (!is_sorted(addrs.begin(), addrs.end()))
+        sort(addrs.begin(), addrs.end());
+
+    for (int addr : addrs) {
+        int order = release_allocation(addr);
+        if (order != -1)
+            release_block(addr, order);
+    }
+}
+
+long long BuddyAllocator::get_split_count() const {
+    return split_count;
+}
+
+long long BuddyAllocator::get_merge_count() const {
+    return merge_count;
 }
 
 int BuddyAllocator::get_used_memory() const {
@@ -96,50 +313,50 @@ int BuddyAllocator::get_used_memory() const {
 }
 
 int BuddyAllocator::get_order(int addr) const {
-    auto it = allocated_order.find(addr);
-    return (it == allocated_order.end()) ? -1 : it->second;
+    if (addr < 0 || addr >= total_size || (addr & ((1 << min_order) - 1)))
+        return -1;
+    int order = alloc_order[addr >> min_order];
+    return (order == NO_ORDER) ? -1 : order;
+}
+
+int BuddyAllocator::get_block_id(int addr) const {
+    return (get_order(addr) == -1) ? -1 : (int)block_id[addr >> min_order];
+}
+
+int BuddyAllocator::find_block(int id) const {
+    auto it = id_to_addr.find(id);
+    return (it == id_to_addr.end()) ? -1 : it->second;
 }
 
 
 void BuddyAllocator::dump_free_lists() {
     cout << "---- Buddy Free Lists ----\n";
     for (int i = min_order; i <= max_order; i++) {
-        if(free_list[i].size()!=0){
+        if(free_head[i]!=-1){
         cout << "Order " << i << " (size " << (1 << i) << "): ";
         
-        for (int addr : free_list[i])
-            cout << "0x" << hex << addr << dec << " ";
+        for (int b = free_head[i]; b != -1; b = next_free[b])
+            cout << "0x" << hex << (b << min_order) << dec << " ";
         cout << "\n";
         }
     }
 }
 
 int BuddyAllocator::get_internal_fragmentation() const {
-    int total = 0;
-
-    for (auto &p : allocated_order) {
-        int addr = p.first;
-        int order = p.second;
-
-        int allocated = 1 << order;
-        int requested = requested_size.at(addr);
-
-        total += (allocated - requested);
-    }
-
-    return total;
+    return internal_frag;
 }
 
 void BuddyAllocator::dump_allocations() const {
     cout << "---- Buddy Allocations ----\n";
     cout << "Addr\tReq\tAlloc\tInternalFrag\n";
 
-    for (auto &p : allocated_order) {
-        int addr = p.first;
-        int order = p.second;
+    for (int b = 0; b < (int)alloc_order.size(); b++) {
+        if (alloc_order[b] == NO_ORDER)
+            continue;
 
-        int allocated = 1 << order;
-        int requested = requested_size.at(addr);
+        int addr = b << min_order;
+        int allocated = 1 << alloc_order[b];
+        int requested = requested_size[b];
 
         cout << "0x" << hex << addr << dec << "\t"
              << requested << "\t"
@@ -0,0 +1,418 @@
+#include "../include/cache_hierarchy.h"
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+
+CacheLevel *make_cache_level(CachePolicy policy, int size, int block, int ways) {
+    switch (policy) {
+        case POLICY_LRU:    return new CacheLevelOf<LruCache>(size, block, ways);
+        case POLICY_PLRU:   return new CacheLevelOf<PlruCache>(size, block, ways);
+        case POLICY_SRRIP:  return new CacheLevelOf<SrripCache>(size, block, ways);
+        case POLICY_RANDOM: return new CacheLevelOf<RandomCache>(size, block, ways);
+        default:            return new CacheLevelOf<Cache>(size, block, ways);
+    }
+}
+
+const char *inclusion_name(InclusionPolicy p) {
+    switch (p) {
+        case INCL_INCLUSIVE: return "Inclusive";
+        case INCL_EXCLUSIVE: return "Exclusive";
+        default:             return "NINE";
+    }
+}
+
+const char *write_policy_name(WritePolicy p) {
+    return p == WRITE_THROUGH ? "Write-Through" : "Write-Back";
+}
+
+const char *write_miss_name(WriteMissPolicy p) {
+    return p == NO_WRITE_ALLOCATE ? "No-Write-Allocate" : "Write-Allocate";
+}
+
+CacheHierarchy::CacheHierarchy(InclusionPolicy inclusion, int memory_latency)
+    : inclusion(inclusion), memory_latency(memory_latency) {}
+
+void CacheHierarchy::add_level(CacheLevel *cache, int latency) {
+    levels.emplace_back();
+    levels.back().cache.reset(cache);
+    levels.back().latency = latency;
+}
+
+void CacheHierarchy::set_prefetcher(int level, Prefetcher *prefetcher) {
+    Level &L = levels[level];
+    L.prefetcher.reset(prefetcher);
+    L.pending.clear();
+    L.buffer.clear();
+}
+
+void CacheHierarchy::set_write_policy(WritePolicy wp, WriteMissPolicy wm) {
+    write_policy = wp;
+    write_miss = wm;
+}
+
+void CacheHierarchy::set_victim_cache(int level, int entries) {
+    Level &L = levels[level];
+    int block = L.cache->get_block_size();
+    L.victims.reset(entries > 0 ? new LruCache(entries * block, block, entries) : nullptr);
+    L.victim_entries = max(entries, 0);
+}
+
+void CacheHierarchy::enable_set_stats() {
+    for (Level &L : levels)
+        L.cache->enable_set_stats();
+}
+
+const char *CacheHierarchy::prefetcher_name(int level) const {
+    return levels[level].prefetcher ? levels[level].prefetcher->name() : "None";
+}
+
+int CacheHierarchy::block_of(int level, int address) const {
+    return address - address % levels[level].cache->get_block_size();
+}
+
+// Every fill and removal at a level goes through these two, so a prefetched
+// block that leaves the level before any demand use is counted as useless.
+int CacheHierarchy::insert_block(int level, int address, bool dirty, bool *victim_dirty) {
+    Level &L = levels[level];
+    int victim = L.cache->insert(address, dirty, victim_dirty);
+    if (victim != -1 && !L.pending.empty()) {
+        auto it = L.pending.find(victim);
+        if (it != L.pending.end() && !it->second.in_buffer) {
+            L.pending.erase(it);
+            L.useless++;
+        }
+    }
+    return victim;
+}
+
+bool CacheHierarchy::drop_block(int level, int address, bool *was_dirty) {
+    Level &L = levels[level];
+    if (!L.cache->invalidate(address, was_dirty))
+        return L.victims && L.victims->invalidate(address, was_dirty);
+    if (!L.pending.empty()) {
+        auto it = L.pending.find(block_of(level, address));
+        if (it != L.pending.end() && !it->second.in_buffer) {
+            L.pending.erase(it);
+            L.useless++;
+        }
+    }
+    return true;
+}
+
+bool CacheHierarchy::held(int level, int address) {
+    Level &L = levels[level];
+    return L.cache->contains(address) || (L.victims && L.victims->contains(address));
+}
+
+// A block evicted from `level` goes into the level's victim cache, if it
+// has one. Returns the block that really leaves the level, or -1, and
+// updates `dirty` to match it.
+int CacheHierarchy::spill(int level, int block_addr, bool &dirty) {
+    Level &L = levels[level];
+    if (!L.victims || block_addr == -1)
+        return block_addr;
+    return L.victims->insert(block_addr, dirty, &dirty);
+}
+
+// An inclusive level evicted block_addr, so no level above it may keep any
+// part of that block. Returns whether any of the dropped copies was dirty.
+bool CacheHierarchy::back_invalidate(int level, int block_addr) {
+    int end = block_addr + levels[level].cache->get_block_size();
+    bool any_dirty = false;
+
+    for (int j = 0; j < level; j++) {
+        int step = levels[j].cache->get_block_size();
+        for (int a = block_addr; a < end; a += step) {
+            bool dirty = false;
+            if (drop_block(j, a, &dirty))
+                back_invalidations++;
+            any_dirty = any_dirty || dirty;
+        }
+    }
+    return any_dirty;
+}
+
+// block_addr was evicted from `level` (NINE or inclusive). Dirty data,
+// including that of any back-invalidated copies, goes one level down.
+void CacheHierarchy::evict(int level, int block_addr, bool dirty, int &spent) {
+    block_addr = spill(level, block_addr, dirty);
+    if (block_addr == -1)
+        return;
+    if (inclusion == INCL_INCLUSIVE && level > 0 && back_invalidate(level, block_addr))
+        dirty = true;
+    if (dirty)
+        write_back(level, block_addr, spent);
+}
+
+// Writes a dirty block from `level` into the next level, or into memory
+// from the last level, charging that level's latency.
+void CacheHierarchy::write_back(int level, int block_addr, int &spent) {
+    levels[level].writebacks++;
+    int next = level + 1;
+    if (next == (int)levels.size()) {
+        memory_writes++;
+        spent += memory_latency;
+        return;
+    }
+
+    spent += levels[next].latency;
+    if (levels[next].cache->mark_dirty(block_addr))
+        return;
+
+    bool victim_dirty = false;
+    int victim = insert_block(next, block_addr, true, &victim_dirty);
+    if (victim != -1)
+        evict(next, victim, victim_dirty, spent);
+}
+
+// Exclusive fill: the block goes into `level` only, and each level's victim
+// moves one level down. The last level's victim leaves the hierarchy. Only
+// dirty victims cost a write.
+void CacheHierarchy::fill_exclusive(int level, int address, bool dirty, int &spent) {
+    int n = (int)levels.size();
+    bool victim_dirty = false;
+    int victim = insert_block(level, address, dirty, &victim_dirty);
+
+    for (int k = level + 1; k <= n; k++) {
+        victim = spill(k - 1, victim, victim_dirty);
+        if (victim == -1)
+            break;
+        if (victim_dirty) {
+            levels[k - 1].writebacks++;
+            spent += (k < n) ? levels[k].latency : memory_latency;
+        }
+        if (k == n) {
+            if (victim_dirty)
+                memory_writes++;
+            break;
+        }
+        victim = insert_block(k, victim, victim_dirty, &victim_dirty);
+    }
+}
+
+// Inclusive fill of `level` and every level below it that lacks the block,
+// bottom-up as for demand fills.
+void CacheHierarchy::fill_inclusive(int level, int address, int &spent) {
+    for (int k = (int)levels.size() - 1; k >= level; k--) {
+        if (held(k, address))
+            continue;
+        bool victim_dirty = false;
+        int victim = insert_block(k, address, false, &victim_dirty);
+        if (victim != -1)
+            evict(k, victim, victim_dirty, spent);
+    }
+}
+
+// First demand use of a prefetched block at `level`. Returns the cycles the
+// access still has to wait if the prefetch has not completed yet.
+int CacheHierarchy::use_prefetch(int level, int block_addr) {
+    Level &L = levels[level];
+    auto it = L.pending.find(block_addr);
+    long long ready = it->second.ready;
+    if (it->second.in_buffer)
+        L.buffer.erase(find(L.buffer.begin(), L.buffer.end(), block_addr));
+    L.pending.erase(it);
+
+    L.useful++;
+    if (ready <= cycles)
+        return 0;
+    L.late++;
+    return (int)(ready - cycles);
+}
+
+void CacheHierarchy::issue_prefetches(int level, int block_addr, PrefetchOutcome outcome, int &spent) {
+    Level &L = levels[level];
+    candidates.clear();
+    L.prefetcher->observe(block_addr, outcome, candidates);
+    if (candidates.empty())
+        return;
+
+    // The data comes from memory, through every level below this one.
+    long long ready = cycles + spent + memory_latency;
+    for (size_t k = level + 1; k < levels.size(); k++)
+        ready += levels[k].latency;
+
+    bool to_buffer = L.prefetcher->uses_buffer();
+    for (int c : candidates) {
+        if (L.pending.count(c) || held(level, c))
+            continue;
+        if (inclusion == INCL_EXCLUSIVE) {
+            bool elsewhere = false;
+            for (int k = 0; k < (int)levels.size(); k++)
+                elsewhere = elsewhere || held(k, c);
+            if (elsewhere)
+                continue;
+        }
+
+        L.issued++;
+        if (to_buffer) {
+            if ((int)L.buffer.size() == PREFETCH_BUFFER_BLOCKS) {
+                L.pending.erase(L.buffer.front());
+                L.buffer.pop_front();
+                L.useless++;
+            }
+            L.buffer.push_back(c);
+        } else if (inclusion == INCL_INCLUSIVE) {
+            fill_inclusive(level, c, spent);
+        } else if (inclusion == INCL_EXCLUSIVE) {
+            fill_exclusive(level, c, false, spent);
+        } else {
+            bool victim_dirty = false;
+            int victim = insert_block(level, c, false, &victim_dirty);
+            if (victim != -1)
+                evict(level, victim, victim_dirty, spent);
+        }
+        L.pending[c] = {ready, to_buffer};
+    }
+}
+
+int CacheHierarchy::access(int address, int *cost, AccessType type) {
+    int n = (int)levels.size();
+    int spent = 0;
+    int hit = n;
+    bool from_buffer = false;
+    bool from_victims = false;
+    bool victim_dirty = false;
+    bool from_prefetch = false;
+
+    for (int k = 0; k < n; k++) {
+        Level &L = levels[k];
+        spent += L.latency;
+        bool found = L.cache->lookup(address);
+        if (!L.pending.empty()) {
+            auto it = L.pending.find(block_of(k, address));
+            if (it != L.pending.end() && (found || it->second.in_buffer)) {
+                from_buffer = !found;
+                from_prefetch = true;
+                spent += use_prefetch(k, it->first);
+                found = true;
+            }
+        }
+        if (!found && L.victims) {
+            // Probed only after the level misses, so it adds its own latency.
+            L.victim_probes++;
+            spent += VICTIM_CACHE_LATENCY;
+            if (L.victims->invalidate(address, &victim_dirty)) {
+                L.victim_hits++;
+                from_victims = found = true;
+            }
+        }
+        if (found) {
+            hit = k;
+            break;
+        }
+        if (L.prefetcher)
+            L.demand_misses++;
+    }
+    if (hit == n)
+        spent += memory_latency;
+
+    // Levels [bottom, top] receive the block. A stream-buffer or victim
+    // cache hit moves the block into its own level as well; a write miss
+    // without write-allocate fills nothing else.
+    bool write = type == ACCESS_WRITE;
+    bool allocate = !write || write_miss == WRITE_ALLOCATE;
+    bool refill = from_buffer || from_victims;
+    int top = refill ? hit : hit - 1;
+    int bottom = allocate ? 0 : hit;
+    if (top >= bottom) {
+        if (inclusion == INCL_EXCLUSIVE) {
+            bool dirty = victim_dirty;
+            if (!refill && hit < n)
+                drop_block(hit, address, &dirty);
+            fill_exclusive(bottom, address, dirty, spent);
+        } else if (from_buffer && inclusion == INCL_INCLUSIVE) {
+            fill_inclusive(bottom, address, spent);
+        } else {
+            // Fill from the bottom up, so an inclusive back-invalidation
+            // never removes a block that was just placed above it.
+            for (int k = top; k >= bottom; k--) {
+                bool dirty = false;
+                int victim = insert_block(k, address, k == hit && victim_dirty, &dirty);
+                if (victim != -1)
+                    evict(k, victim, dirty, spent);
+            }
+        }
+    }
+
+    if (write) {
+        // The level now holding the block takes the write, or memory does.
+        writes++;
+        int target = allocate ? 0 : hit;
+        if (target == n) {
+            memory_writes++;
+        } else if (write_policy == WRITE_THROUGH) {
+            memory_writes++;
+            spent += memory_latency;
+        } else {
+            levels[target].cache->mark_dirty(address);
+        }
+    }
+
+    // Train each level's prefetcher on the accesses that reached it.
+    for (int k = 0; k <= hit && k < n; k++) {
+        if (!levels[k].prefetcher)
+            continue;
+        PrefetchOutcome outcome = PF_MISS;
+        if (k == hit)
+            outcome = from_prefetch ? PF_PREFETCH_HIT : PF_HIT;
+        issue_prefetches(k, block_of(k, address), outcome, spent);
+    }
+
+    accesses++;
+    cycles += spent;
+    if (cost)
+        *cost = spent;
+    return hit;
+}
+
+double CacheHierarchy::average_latency() const {
+    return accesses ? (double)cycles / accesses : 0.0;
+}
+
+static double percent(long long part, long long whole) {
+    return whole ? part * 100.0 / whole : 0.0;
+}
+
+void CacheHierarchy::print_stats() const {
+    for (size_t k = 0; k < levels.size(); k++) {
+        const Level &L = levels[k];
+        string name = "L" + to_string(k + 1);
+        L.cache->print_stats(name);
+        cout << name << " Writebacks: " << L.writebacks << "\n";
+        if (L.cache->get_set_stats())
+            L.cache->get_set_stats()->print_summary(name);
+        if (L.victims)
+            cout << name << " Victim Cache: " << L.victim_entries << " entries, "
+                 << L.victim_hits << " hits in " << L.victim_probes << " probes\n";
+        if (!L.prefetcher)
+            continue;
+
+        cout << name << " Prefetcher: " << L.prefetcher->name()
+             << (L.prefetcher->uses_buffer() ? " (into buffer)" : " (into cache)") << "\n";
+        cout << name << " Prefetches Issued: " << L.issued << " (useful: " << L.useful
+             << ", late: " << L.late << ", useless: " << L.useless << ")\n";
+        cout << name << " Prefetch Accuracy: " << percent(L.useful, L.issued) << "%\n";
+        cout << name << " Prefetch Coverage: " << percent(L.useful, L.useful + L.demand_misses) << "%\n";
+        cout << name << " Prefetch Timeliness: " << percent(L.useful - L.late, L.useful) << "%\n";
+    }
+
+    cout << "Write Policy: " << write_policy_name(write_policy) << ", " << write_miss_name(write_miss) << "\n";
+    cout << "Writes: " << writes << "\n";
+    cout << "Memory Writes: " << memory_writes << "\n";
+}
+
+bool CacheHierarchy::write_set_histogram(ostream &out) const {
+    bool any = false;
+    for (size_t k = 0; k < levels.size(); k++) {
+        const SetStats *stats = levels[k].cache->get_set_stats();
+        if (!stats)
+            continue;
+        if (!any)
+            out << "level,set,accesses,misses,compulsory,capacity,conflict\n";
+        stats->write_histogram(out, "L" + to_string(k + 1));
+        any = true;
+    }
+    return any;
+}
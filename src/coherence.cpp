@@ -0,0 +1,191 @@
+#include "../include/coherence.h"
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+
+using namespace std;
+
+const char *protocol_name(CoherenceProtocol p) {
+    return p == PROTO_MOESI ? "MOESI" : "MESI";
+}
+
+CoherentSystem::CoherentSystem(int cores, int l1_size, int block, int l1_ways,
+                               int llc_size, int llc_ways, CoherenceProtocol protocol)
+    : cores(cores), block_size(block), protocol(protocol) {
+    if (cores < 1 || cores > 64)
+        throw invalid_argument("core count must be between 1 and 64");
+
+    // False sharing is tracked per word, with at most 64 words per line.
+    word_size = max(4, (block + 63) / 64);
+
+    for (int c = 0; c < cores; c++)
+        l1.emplace_back(new Cache(l1_size, block, l1_ways));
+    llc.reset(new Cache(llc_size, block, llc_ways));
+}
+
+int CoherentSystem::word_bit(int address) const {
+    return (address % block_size) / word_size;
+}
+
+// A capacity eviction from core's L1. Dirty data is written back to the LLC;
+// with MOESI the remaining sharers keep their clean copies.
+void CoherentSystem::evict_from_l1(int core, int line_addr) {
+    auto it = lines.find(line_addr);
+    if (it == lines.end())
+        return;
+
+    LineState &st = it->second;
+    st.sharers &= ~(1ull << core);
+    if (st.owner == core) {
+        if (st.dirty) {
+            writebacks++;
+            llc->insert(line_addr);
+        }
+        st.owner = -1;
+        st.dirty = false;
+    }
+    if (!st.sharers && !st.lost)
+        lines.erase(it);
+}
+
+// Records a write to `word` against every core still waiting to re-fetch the
+// line, so its next miss can be told apart as true or false sharing.
+void CoherentSystem::note_write(int core, LineState &st, uint64_t word) {
+    uint64_t waiting = st.lost & ~(1ull << core);
+    for (int k = 0; waiting; k++, waiting >>= 1)
+        if (waiting & 1)
+            st.written[k] |= word;
+}
+
+int CoherentSystem::invalidate_others(int core, int line_addr, LineState &st, uint64_t word) {
+    int count = 0;
+    uint64_t others = st.sharers & ~(1ull << core);
+    for (int k = 0; others; k++, others >>= 1) {
+        if (!(others & 1))
+            continue;
+        l1[k]->invalidate(line_addr);
+        if (st.written.empty())
+            st.written.assign(cores, 0);
+        st.lost |= 1ull << k;
+        st.written[k] = word;
+        count++;
+    }
+
+    st.sharers &= 1ull << core;
+    if (st.owner != core) {
+        st.owner = -1;
+        st.dirty = false;
+    }
+    invalidations += count;
+    return count;
+}
+
+CoherenceSource CoherentSystem::fetch_shared(int line_addr) {
+    return llc->access(line_addr) ? SRC_LLC : SRC_MEMORY;
+}
+
+CoherenceResult CoherentSystem::access(int core, int address, AccessType type) {
+    int line_addr = address - address % block_size;
+    uint64_t me = 1ull << core;
+    uint64_t word = 1ull << word_bit(address);
+
+    CoherenceResult r = {SRC_L1, -1, 0, l1_penalty};
+    LineState &st = lines[line_addr];
+
+    if (l1[core]->lookup(line_addr)) {
+        if (type == ACCESS_READ)
+            return r;
+
+        note_write(core, st, word);
+        if (st.owner == core && st.sharers == me) {
+            // E or M: silent upgrade to M.
+            st.dirty = true;
+            return r;
+        }
+
+        // S or O: invalidate the other copies to gain ownership.
+        upgrades++;
+        r.source = SRC_UPGRADE;
+        r.invalidated = invalidate_others(core, line_addr, st, word);
+        r.cycles += l2_penalty;
+        st.owner = core;
+        st.dirty = true;
+        return r;
+    }
+
+    // L1 miss. A core whose copy was invalidated by someone else's write
+    // misses for coherence; it is false sharing if none of the words written
+    // since then is the one it needs now.
+    if (st.lost & me) {
+        coherence_misses++;
+        if (!(st.written[core] & word))
+            false_sharing_misses++;
+        st.lost &= ~me;
+    }
+
+    int owner = st.owner;
+    bool dirty_peer = owner != -1 && owner != core && st.dirty;
+
+    r.cycles += l2_penalty;
+    if (dirty_peer) {
+        peer_transfers++;
+        r.source = SRC_PEER;
+        r.peer = owner;
+    } else {
+        r.source = fetch_shared(line_addr);
+        if (r.source == SRC_MEMORY)
+            r.cycles += memory_penalty;
+    }
+
+    if (type == ACCESS_WRITE) {
+        note_write(core, st, word);
+        r.invalidated = invalidate_others(core, line_addr, st, word);
+        st.owner = core;
+        st.dirty = true;
+    } else if (st.sharers == 0) {
+        st.owner = core;            // E
+        st.dirty = false;
+    } else if (dirty_peer && protocol == PROTO_MOESI) {
+        // M -> O: the owner keeps the dirty line and shares it.
+    } else {
+        if (dirty_peer) {
+            writebacks++;           // M -> S writes the line back
+            llc->insert(line_addr);
+        }
+        st.owner = -1;              // E/M -> S
+        st.dirty = false;
+    }
+    st.sharers |= me;
+
+    int victim = l1[core]->insert(line_addr);
+    if (victim != -1)
+        evict_from_l1(core, victim);
+    return r;
+}
+
+char CoherentSystem::state_of(int core, int address) const {
+    auto it = lines.find(address - address % block_size);
+    if (it == lines.end() || !(it->second.sharers & (1ull << core)))
+        return 'I';
+
+    const LineState &st = it->second;
+    if (st.owner != core)
+        return 'S';
+    if (!st.dirty)
+        return 'E';
+    return st.sharers == (1ull << core) ? 'M' : 'O';
+}
+
+void CoherentSystem::print_stats() const {
+    for (int c = 0; c < cores; c++)
+        l1[c]->print_stats("Core " + to_string(c) + " L1");
+    llc->print_stats("LLC");
+
+    cout << "Coherence Protocol: " << protocol_name(protocol) << "\n";
+    cout << "Invalidations: " << invalidations << "\n";
+    cout << "Upgrades: " << upgrades << "\n";
+    cout << "Coherence Misses: " << coherence_misses
+         << " (false sharing: " << false_sharing_misses << ")\n";
+    cout << "Cache-to-Cache Transfers: " << peer_transfers << "\n";
+    cout << "Writebacks: " << writebacks << "\n";
+}
@@ -0,0 +1,302 @@
+#include "../include/concurrent_buddy.h"
+#include <stdexcept>
+#include <unordered_map>
+#include <algorithm>
+#include <thread>
+
+using namespace std;
+
+static atomic<uint64_t> next_serial{1};
+
+bool ConcurrentBuddyAllocator::is_power_of_two(int x) const {
+    return x && !(x & (x - 1));
+}
+
+int ConcurrentBuddyAllocator::size_to_order(int size) const {
+    int order = 0;
+    int val = 1;
+    while (val < size) {
+        val <<= 1;
+        order++;
+    }
+    return order;
+}
+
+ConcurrentBuddyAllocator::ConcurrentBuddyAllocator(int memory_size, int min_block_size, int magazine_blocks) {
+    if (!is_power_of_two(memory_size) || !is_power_of_two(min_block_size)) {
+        throw runtime_error("Sizes must be power of two");
+    }
+
+    total_size = memory_size;
+    min_order = size_to_order(min_block_size);
+    max_order = size_to_order(memory_size);
+    magazine_size = magazine_blocks;
+    serial = next_serial++;
+
+    int blocks = max(1, total_size >> min_order);
+    next_free.assign(blocks, -1);
+    prev_free.assign(blocks, -1);
+    alloc_order.reset(new atomic<uint8_t>[blocks]);
+    for (int b = 0; b < blocks; b++)
+        alloc_order[b].store(NO_ORDER, memory_order_relaxed);
+
+    lists.reset(new OrderList[max_order + 1]);
+    for (int o = min_order; o <= max_order; o++) {
+        int count = max(1, total_size >> o);
+        lists[o].free_bits.assign((count + 63) / 64, 0);
+    }
+
+    push_locked(0, max_order);
+}
+
+bool ConcurrentBuddyAllocator::test_free(int addr, int order) const {
+    int i = addr >> order;
+    return (lists[order].free_bits[i >> 6] >> (i & 63)) & 1;
+}
+
+void ConcurrentBuddyAllocator::push_locked(int addr, int order) {
+    OrderList &lst = lists[order];
+    int i = addr >> order;
+    int b = addr >> min_order;
+
+    lst.free_bits[i >> 6] |= 1ull << (i & 63);
+    prev_free[b] = -1;
+    next_free[b] = lst.head;
+    if (lst.head != -1)
+        prev_free[lst.head] = b;
+    lst.head = b;
+}
+
+void ConcurrentBuddyAllocator::unlink_locked(int addr, int order) {
+    OrderList &lst = lists[order];
+    int i = addr >> order;
+    int b = addr >> min_order;
+
+    lst.free_bits[i >> 6] &= ~(1ull << (i & 63));
+    if (prev_free[b] != -1)
+        next_free[prev_free[b]] = next_free[b];
+    else
+        lst.head = next_free[b];
+    if (next_free[b] != -1)
+        prev_free[next_free[b]] = prev_free[b];
+}
+
+// Takes the first order with a free block, one lock at a time, and pushes the
+// upper halves of each split onto the lower orders. Only one lock is ever
+// held, so the core cannot deadlock. A block being split or merged is briefly
+// on no list and counted in in_flight; a scan that misses it is retried by
+// slow_alloc.
+int ConcurrentBuddyAllocator::core_alloc(int order) {
+    for (int o = order; o <= max_order; o++) {
+        OrderList &lst = lists[o];
+        lst.lock.lock();
+        if (lst.head == -1) {
+            lst.lock.unlock();
+            continue;
+        }
+
+        int addr = lst.head << min_order;
+        unlink_locked(addr, o);
+        if (o > order)
+            in_flight++;
+        lst.lock.unlock();
+
+        if (o > order) {
+            while (o > order) {
+                o--;
+                lock_guard<mutex> g(lists[o].lock);
+                push_locked(addr + (1 << o), o);
+            }
+            in_flight--;
+        }
+        return addr;
+    }
+    return -1;
+}
+
+int ConcurrentBuddyAllocator::core_alloc_batch(int order, int count, vector<int> &out) {
+    int got = 0;
+    {
+        lock_guard<mutex> g(lists[order].lock);
+        while (got < count && lists[order].head != -1) {
+            int addr = lists[order].head << min_order;
+            unlink_locked(addr, order);
+            out.push_back(addr);
+            got++;
+        }
+    }
+
+    if (got == 0) {
+        int addr = core_alloc(order);
+        if (addr != -1) {
+            out.push_back(addr);
+            got++;
+        }
+    }
+    return got;
+}
+
+// A merged block is on no list until it is pushed at its final order.
+void ConcurrentBuddyAllocator::core_free(int addr, int order) {
+    bool merging = false;
+    while (true) {
+        OrderList &lst = lists[order];
+        lock_guard<mutex> g(lst.lock);
+
+        if (order < max_order) {
+            int buddy = addr ^ (1 << order);
+            if (test_free(buddy, order)) {
+                unlink_locked(buddy, order);
+                if (!merging)
+                    in_flight++;
+                merging = true;
+                addr = min(addr, buddy);
+                order++;
+                continue;
+            }
+        }
+
+        push_locked(addr, order);
+        if (merging)
+            in_flight--;
+        return;
+    }
+}
+
+// Called when the fast path found no block. Every magazine is drained back
+// into the core so cached blocks can merge, then the core is scanned with all
+// order locks held (in ascending order, the only place more than one is
+// taken). While a split or merge is in flight its block is on no list, so the
+// scan is repeated until it either succeeds or runs with nothing in flight.
+int ConcurrentBuddyAllocator::slow_alloc(int order) {
+    if (magazine_size > 0) {
+        vector<shared_ptr<Magazine>> all;
+        {
+            lock_guard<mutex> g(magazines_lock);
+            all = magazines;
+        }
+        for (auto &mag : all)
+            drain_magazine(*mag);
+    }
+
+    while (true) {
+        for (int o = min_order; o <= max_order; o++)
+            lists[o].lock.lock();
+
+        int addr = -1;
+        for (int o = order; o <= max_order && addr == -1; o++) {
+            if (lists[o].head == -1)
+                continue;
+            addr = lists[o].head << min_order;
+            unlink_locked(addr, o);
+            while (o > order) {
+                o--;
+                push_locked(addr + (1 << o), o);
+            }
+        }
+        bool settled = in_flight.load() == 0;
+
+        for (int o = max_order; o >= min_order; o--)
+            lists[o].lock.unlock();
+
+        if (addr != -1 || settled)
+            return addr;
+        this_thread::yield();
+    }
+}
+
+void ConcurrentBuddyAllocator::drain_magazine(Magazine &mag) {
+    lock_guard<SpinLock> g(mag.lock);
+    for (int o = min_order; o <= max_order; o++) {
+        for (int addr : mag.blocks[o])
+            core_free(addr, o);
+        mag.blocks[o].clear();
+    }
+}
+
+ConcurrentBuddyAllocator::Magazine &ConcurrentBuddyAllocator::thread_magazine() {
+    static thread_local unordered_map<uint64_t, shared_ptr<Magazine>> caches;
+
+    auto &mag = caches[serial];
+    if (!mag) {
+        mag = make_shared<Magazine>();
+        mag->blocks.resize(max_order + 1);
+        lock_guard<mutex> g(magazines_lock);
+        magazines.push_back(mag);
+    }
+    return *mag;
+}
+
+int ConcurrentBuddyAllocator::buddy_malloc(int size) {
+    int order = size_to_order(size);
+    if (order < min_order)
+        order = min_order;
+    if (order > max_order)
+        return -1;
+
+    int addr = -1;
+    if (magazine_size > 0) {
+        Magazine &mag = thread_magazine();
+        lock_guard<SpinLock> g(mag.lock);
+        auto &cached = mag.blocks[order];
+        if (cached.empty())
+            core_alloc_batch(order, max(1, magazine_size / 2), cached);
+        if (!cached.empty()) {
+            addr = cached.back();
+            cached.pop_back();
+        }
+    } else {
+        addr = core_alloc(order);
+    }
+    if (addr == -1)
+        addr = slow_alloc(order);
+    if (addr == -1)
+        return -1;
+
+    alloc_order[addr >> min_order].store((uint8_t)order, memory_order_relaxed);
+    used_memory += 1 << order;
+    return addr;
+}
+
+void ConcurrentBuddyAllocator::buddy_free(int addr) {
+    if (addr < 0 || addr >= total_size || (addr & ((1 << min_order) - 1)))
+        return;
+
+    int order = alloc_order[addr >> min_order].exchange(NO_ORDER, memory_order_relaxed);
+    if (order == NO_ORDER)
+        return;
+    used_memory -= 1 << order;
+
+    if (magazine_size == 0) {
+        core_free(addr, order);
+        return;
+    }
+
+    Magazine &mag = thread_magazine();
+    lock_guard<SpinLock> g(mag.lock);
+    auto &cached = mag.blocks[order];
+    cached.push_back(addr);
+    if ((int)cached.size() > magazine_size) {
+        int keep = magazine_size / 2;
+        for (int i = keep; i < (int)cached.size(); i++)
+            core_free(cached[i], order);
+        cached.resize(keep);
+    }
+}
+
+void ConcurrentBuddyAllocator::flush_thread_cache() {
+    if (magazine_size == 0)
+        return;
+    drain_magazine(thread_magazine());
+}
+
+long long ConcurrentBuddyAllocator::get_used_memory() const {
+    return used_memory.load();
+}
+
+int ConcurrentBuddyAllocator::get_order(int addr) const {
+    if (addr < 0 || addr >= total_size || (addr & ((1 << min_order) - 1)))
+        return -1;
+    int order = alloc_order[addr >> min_order].load(memory_order_relaxed);
+    return (order == NO_ORDER) ? -1 : order;
+}
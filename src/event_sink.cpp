@@ -0,0 +1,155 @@
+#include "../include/event_sink.h"
+#include <iostream>
+
+using namespace std;
+
+static TextEventSink text_sink;
+EventSink *event_sink = &text_sink;
+
+void TextEventSink::emit(const SimEvent &e) {
+    switch (e.type) {
+        case EV_INVALID_ADDRESS:
+            cout << "Invalid virtual address: " << e.addr << "\n";
+            break;
+
+        case EV_TLB_HIT:
+        case EV_TLB_MISS:
+            for (int k = 0; k < e.level; k++)
+                cout << "L" << k + 1 << " TLB miss. ";
+            if (e.type == EV_TLB_HIT)
+                cout << "L" << e.level + 1 << " TLB hit.\n";
+            else
+                cout << "Walking page table.\n";
+            break;
+
+        case EV_PAGE_WALK:
+            if (!verbose)
+                break;
+            cout << "Page walk: " << (int)e.level << (e.level == 1 ? " level, " : " levels, ")
+                 << e.value << " cycles\n";
+            break;
+
+        case EV_PAGE_HIT:
+            cout << "PAGE HIT (PID " << e.pid
+             << ", page " << e.addr
+             << ", frame " << e.frame << ")\n";
+            break;
+
+        case EV_PAGE_FAULT:
+            cout << "PAGE FAULT (PID " << e.pid << ", page " << e.addr << ")\n";
+            break;
+
+        case EV_PAGE_EVICTION:
+            cout << "PAGE EVICTION: PID "
+                << e.pid << ", frame " << e.frame;
+            if (e.flags & EVF_DIRTY)
+                cout << " (dirty, written back)";
+            cout << "\n";
+            break;
+
+        case EV_PAGE_MAPPED:
+            cout << "Mapped (PID " << e.pid
+                 << ", page " << e.addr
+                 << ") -> frame " << e.frame << "\n";
+            break;
+
+        case EV_CACHE_ACCESS:
+            if (e.level == 0) {
+                cout << "L1 hit!\n";
+                break;
+            }
+            for (int k = 0; k < e.level; k++)
+                cout << (k ? " L" : "L") << k + 1 << " miss.";
+            if (e.level < e.frame)
+                cout << " L" << e.level + 1 << " hit.\n";
+            else
+                cout << " Accessing main memory.\n";
+            break;
+
+        case EV_COHERENT_ACCESS:
+            cout << "Core " << e.pid << ": ";
+            switch (e.level) {
+                case SRC_L1:      cout << "L1 hit!"; break;
+                case SRC_UPGRADE: cout << "L1 hit. Upgrade to exclusive."; break;
+                case SRC_PEER:    cout << "L1 miss. Supplied by core " << e.frame << "."; break;
+                case SRC_LLC:     cout << "L1 miss. LLC hit."; break;
+                case SRC_MEMORY:  cout << "L1 miss. LLC miss. Accessing main memory."; break;
+            }
+            if (e.value)
+                cout << " Invalidated " << e.value << " cop" << (e.value == 1 ? "y" : "ies") << ".";
+            cout << " [" << e.state << "]\n";
+            break;
+    }
+}
+
+void CounterEventSink::emit(const SimEvent &e) {
+    if (e.type >= EV_TYPE_COUNT)
+        return;
+    counts[e.type]++;
+
+    // A cache access past the last level went to memory.
+    int level = e.level;
+    if (level >= MAX_LEVELS || (e.type == EV_CACHE_ACCESS && level >= e.frame))
+        level = MAX_LEVELS;
+    by_level[e.type][level]++;
+}
+
+void CounterEventSink::print_summary() const {
+    static const char *names[EV_TYPE_COUNT] = {
+        "", "Invalid Addresses", "TLB Hits", "TLB Misses", "Page Walks", "Page Hits",
+        "Page Faults", "Page Evictions", "Pages Mapped", "Cache Accesses", "Coherent Accesses",
+    };
+
+    cout << "\n----- Events -----\n";
+    for (int t = 1; t < EV_TYPE_COUNT; t++)
+        cout << names[t] << ": " << counts[t] << "\n";
+
+    // Where TLB and cache lookups were satisfied.
+    for (int k = 0; k < MAX_LEVELS; k++)
+        if (by_level[EV_TLB_HIT][k])
+            cout << "L" << k + 1 << " TLB Hits: " << by_level[EV_TLB_HIT][k] << "\n";
+    for (int k = 0; k < MAX_LEVELS; k++)
+        if (by_level[EV_CACHE_ACCESS][k])
+            cout << "L" << k + 1 << " Cache Hits: " << by_level[EV_CACHE_ACCESS][k] << "\n";
+    if (counts[EV_CACHE_ACCESS])
+        cout << "Main Memory Accesses: " << by_level[EV_CACHE_ACCESS][MAX_LEVELS] << "\n";
+}
+
+BinaryEventLog::BinaryEventLog(const string &path) : path(path), out(path, ios::binary) {
+    buffer.reserve(BUFFER_EVENTS);
+    uint32_t record_size = sizeof(SimEvent);
+    out.write("MSIMEVT1", 8);
+    out.write((const char *)&record_size, sizeof(record_size));
+}
+
+void BinaryEventLog::flush() {
+    if (!buffer.empty()) {
+        out.write((const char *)buffer.data(), buffer.size() * sizeof(SimEvent));
+        written += buffer.size();
+        buffer.clear();
+    }
+    out.flush();
+}
+
+void BinaryEventLog::print_summary() const {
+    cout << "\n----- Events -----\n";
+    cout << "Event Log: " << path << " (" << written + (long long)buffer.size() << " events)\n";
+}
+
+EventSink *make_event_sink(const string &spec) {
+    if (spec == "text")
+        return new TextEventSink();
+    if (spec == "verbose")
+        return new TextEventSink(true);
+    if (spec == "none")
+        return new NullEventSink();
+    if (spec == "counters")
+        return new CounterEventSink();
+    if (spec.compare(0, 7, "binary:") == 0 && spec.size() > 7) {
+        BinaryEventLog *log = new BinaryEventLog(spec.substr(7));
+        if (log->is_open())
+            return log;
+        delete log;
+    }
+    return nullptr;
+}
@@ -2,17 +2,22 @@
 #include <string>
 #include <limits> 
 #include <iomanip>
+#include <vector>
+#include <fstream>
+#include <unordered_set>
 
 #include "../include/memory.h"
 #include "../include/buddy.h"
-#include "../include/cache.h"
+#include "../include/cache_hierarchy.h"
+#include "../include/coherence.h"
 #include "../include/vm.h"
 
 using namespace std;
 
 BuddyAllocator* sys_buddy = nullptr;
-Cache* primary_cache = nullptr;    
-Cache* secondary_cache = nullptr;  
+CacheHierarchy* cache_system = nullptr;
+bool custom_cache_config = false;
+CoherentSystem* coherent_system = nullptr;
 
 int config_ram_size = 0;   
 int config_page_size = 0;  
@@ -26,25 +31,77 @@ enum AllocationStrategy {
 
 AllocationStrategy current_strategy = STRAT_UNSET; 
 
-void perform_memory_lookup(int target_addr) {
+// Multi-core mode: the PID picks the core (pid % cores).
+int core_of(int pid) {
+    int core = pid % coherent_system->core_count();
+    return core < 0 ? core + coherent_system->core_count() : core;
+}
+
+void perform_coherent_lookup(int pid, int target_addr, AccessType type) {
+    int core = core_of(pid);
+    CoherenceResult r = coherent_system->access(core, target_addr, type);
+    total_cycles += r.cycles;
+
+    emit_event(EV_COHERENT_ACCESS, core, target_addr, r.source, r.peer, r.invalidated,
+               type == ACCESS_WRITE ? EVF_WRITE : 0, coherent_system->state_of(core, target_addr));
+}
+
+void perform_memory_lookup(int pid, int target_addr, AccessType type = ACCESS_READ) {
     if (target_addr < 0) return;
 
-    if (primary_cache->access(target_addr)) {
-        total_cycles += l1_penalty;
-        cout << "L1 hit!\n"; 
+    if (coherent_system) {
+        perform_coherent_lookup(pid, target_addr, type);
         return;
     }
 
-    total_cycles += l1_penalty;
+    int cost;
+    int hit = cache_system->access(target_addr, &cost, type);
+    total_cycles += cost;
+
+    emit_event(EV_CACHE_ACCESS, pid, target_addr, hit, cache_system->level_count(), cost,
+               type == ACCESS_WRITE ? EVF_WRITE : 0);
+}
+
+// Page-walk PTE reads go through the same caches as data accesses.
+int page_walk_access(int pid, int pte_addr) {
+    if (coherent_system)
+        return coherent_system->access(core_of(pid), pte_addr, ACCESS_READ).cycles;
 
-    if (secondary_cache->access(target_addr)) {
-        total_cycles += l2_penalty;
-        cout << "L1 miss. L2 hit.\n"; 
+    int cost;
+    cache_system->access(pte_addr, &cost, ACCESS_READ);
+    return cost;
+}
+
+void select_strategy_if_unset() {
+    if (current_strategy != STRAT_UNSET)
         return;
-    }
 
-    total_cycles += l2_penalty + memory_penalty;
-    cout << "L1 miss. L2 miss. Accessing main memory.\n"; 
+    int mode_sel;
+    cout << "   Select Mode: [1] Linear (FF/BF/WF) [2] Buddy System [3] Lazy Buddy: ";
+    cin >> mode_sel;
+    current_strategy = (mode_sel == 2 || mode_sel == 3) ? STRAT_BUDDY : STRAT_LINEAR;
+    if (mode_sel == 3)
+        sys_buddy->set_lazy(true);
+
+    cout << "Allocator mode set to " << (current_strategy == STRAT_BUDDY ? (sys_buddy->is_lazy() ? "LAZY BUDDY\n" : "BUDDY\n") : "LINEAR\n");
+}
+
+int prompt_linear_algo() {
+    int lin_algo;
+    cout << "   Algo: [1] FirstFit [2] BestFit [3] WorstFit [4] TLSF: ";
+    cin >> lin_algo;
+    return lin_algo;
+}
+
+int find_block_by_id(int id, bool &buddy_block) {
+    buddy_block = false;
+    int addr = get_block_start_by_id(id);
+
+    if (addr == -1) {
+        addr = sys_buddy->find_block(id);
+        buddy_block = (addr != -1);
+    }
+    return addr;
 }
 
 void flush_input() {
@@ -63,6 +120,8 @@ void show_main_menu() {
     cout << "  [3] Virtual Memory Management\n";
     cout << "  [4] View Statistics & Dump\n";
     cout << "  [5] Exit Application\n";
+    cout << "  [6] Configure Cache Hierarchy\n";
+    cout << "  [7] Configure Multi-Core Coherence\n";
     cout << "\nInput Choice: ";
 }
 
@@ -72,6 +131,9 @@ void show_vm_submenu() {
     cout << "   [2] Translate & Access Address\n";
     cout << "   [3] Inspect Page Table\n";
     cout << "   [4] Back\n";
+    cout << "   [5] Translate & Write Address\n";
+    cout << "   [6] Select Page Replacement Policy\n";
+    cout << "   [7] Configure TLB\n";
     cout << "\n   Input Choice: ";
 }
 void print_system_report() {
@@ -85,8 +147,7 @@ void print_system_report() {
         int frag_ext = external_fragmentation();
         
         int total = config_ram_size;
-        int free_mem = 0;
-        for (auto &blk : memory_blocks) if (blk.free) free_mem += blk.size;
+        int free_mem = free_memory();
 
         double int_pct = total ? (frag_int * 100.0 / total) : 0.0;
         double ext_pct = free_mem ? (frag_ext * 100.0 / free_mem) : 0.0;
@@ -98,7 +159,7 @@ void print_system_report() {
         allocation_stats(); 
     } 
     else if (current_strategy == STRAT_BUDDY) {
-        cout << "Allocator Type: Buddy System\n";
+        cout << "Allocator Type: Buddy System" << (sys_buddy->is_lazy() ? " (lazy coalescing)\n" : "\n");
         
         int used = sys_buddy->get_used_memory();
         int total = config_ram_size;
@@ -115,6 +176,8 @@ void print_system_report() {
         cout << "Internal Fragmentation: " << internal << " bytes (" << int_pct << "% of allocated memory)\n";
         cout << "External Fragmentation: 0 bytes (0%)\n";
         cout << "Memory Utilization: " << util_pct << "%\n";
+        cout << "Block Splits: " << sys_buddy->get_split_count() << "\n";
+        cout << "Block Merges: " << sys_buddy->get_merge_count() << "\n";
         
         cout << "\nPer Allocation Fragmentation:\n";
         sys_buddy->dump_allocations();
@@ -129,11 +192,25 @@ void print_system_report() {
     
     cout << "Total Page Hits: " << h << "\n";
     cout << "Total Page Faults: " << f << "\n";
+    cout << "Dirty Page Writebacks: " << get_page_writebacks() << "\n";
+    cout << "Disk Cycles: " << get_disk_cycles() << "\n";
+    cout << "Page Replacement Policy: " << page_replacement_name() << "\n";
     
     if (total_vm > 0)
         cout << "Fault Rate: " << (f * 100.0 / total_vm) << "%\n";
     else
         cout << "Fault Rate: 0%\n";
+    cout << "Page Walks: " << get_page_walks() << "\n";
+    cout << "Page Walk Cycles: " << get_walk_cycles() << "\n";
+    cout << "Page Table Memory: " << get_page_table_bytes() << " bytes\n";
+
+    if (tlb_level_count() > 0) {
+        for (int k = 0; k < tlb_level_count(); k++)
+            tlb_level(k).print_stats("L" + to_string(k + 1) + " TLB");
+        cout << "TLB ASIDs: " << (tlb_uses_asids() ? "On" : "Off") << "\n";
+        cout << "TLB Flushes: " << get_tlb_flushes() << "\n";
+        cout << "Translation Cycles: " << get_translation_cycles() << "\n";
+    }
     
     cout << "\nPer-Process Frame Usage:\n";
     if (!any_vm_initialized()) {
@@ -149,14 +226,37 @@ void print_system_report() {
     }
 
     cout << "\n----- Cache -----\n";
-    primary_cache->print_stats("L1");
-    secondary_cache->print_stats("L2");
+    if (coherent_system)
+        coherent_system->print_stats();
+    else
+        cache_system->print_stats();
+    if (custom_cache_config && !coherent_system) {
+        cout << "Inclusion Policy: " << inclusion_name(cache_system->get_inclusion()) << "\n";
+        cout << "Back-Invalidations: " << cache_system->get_back_invalidations() << "\n";
+        cout << "Average Access Latency: " << cache_system->average_latency() << " cycles\n";
+    }
     cout << "Total Memory Access Cycles: " << total_cycles << "\n";
     cout << "Disk Penalty per fault: " << disk_penalty << "\n";
+    event_sink->print_summary();
 }
 
-int main() {
+// Usage: memsim [--events text|verbose|counters|none|binary:<file>]
+// Per-access messages go to the selected event sink; text is the default.
+int main(int argc, char **argv) {
     int user_selection;
+    set_page_walk_handler(page_walk_access);
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        EventSink *sink = nullptr;
+        if (arg == "--events" && i + 1 < argc)
+            sink = make_event_sink(argv[++i]);
+        if (!sink) {
+            cerr << "Usage: memsim [--events text|verbose|counters|none|binary:<file>]\n";
+            return 1;
+        }
+        event_sink = sink;
+    }
 
     while (true) {
         show_main_menu();
@@ -184,6 +284,25 @@ int main() {
                     break;
                 }
 
+                int s1, bl1, as1; 
+                int s2, bl2, as2; 
+                
+                cout << "\n>> L1 Cache (Size BlockSize Assoc): ";
+                cin >> s1 >> bl1 >> as1;
+
+                cout << ">> L2 Cache (Size BlockSize Assoc): ";
+                cin >> s2 >> bl2 >> as2;
+
+                if (s1 <= 0 || bl1 <= 0 || as1 <= 0 || s1 < (long long)bl1 * as1 ||
+                    s2 <= 0 || bl2 <= 0 || as2 <= 0 || s2 < (long long)bl2 * as2) {
+                    cout << "Error: Each level needs Size >= BlockSize * Assoc > 0.\n";
+                    break;
+                }
+                if (as1 > MAX_CACHE_WAYS || as2 > MAX_CACHE_WAYS) {
+                    cout << "Error: Associativity must be at most " << MAX_CACHE_WAYS << " ways.\n";
+                    break;
+                }
+
                 config_ram_size = input_ram;
                 config_page_size = input_page;
                 system_frame_count = input_ram / input_page;
@@ -191,25 +310,18 @@ int main() {
                 reset_allocation_stats();
                 init_memory(config_ram_size);
                 reset_vm_system(config_ram_size, config_page_size);
-                buddy_ids.clear();
                 
                 delete sys_buddy;
-                delete primary_cache;
-                delete secondary_cache;
+                delete cache_system;
+                delete coherent_system;
+                coherent_system = nullptr;
 
                 sys_buddy = new BuddyAllocator(config_ram_size, 128);
 
-                int s1, bl1, as1; 
-                int s2, bl2, as2; 
-                
-                cout << "\n>> L1 Cache (Size BlockSize Assoc): ";
-                cin >> s1 >> bl1 >> as1;
-
-                cout << ">> L2 Cache (Size BlockSize Assoc): ";
-                cin >> s2 >> bl2 >> as2;
-
-                primary_cache = new Cache(s1, bl1, as1);
-                secondary_cache = new Cache(s2, bl2, as2);
+                cache_system = new CacheHierarchy(INCL_NINE, memory_penalty);
+                cache_system->add_level(make_cache_level(POLICY_FIFO, s1, bl1, as1), l1_penalty);
+                cache_system->add_level(make_cache_level(POLICY_FIFO, s2, bl2, as2), l2_penalty);
+                custom_cache_config = false;
 
                 current_strategy = STRAT_UNSET;
                 total_cycles = 0;
@@ -231,7 +343,7 @@ int main() {
                 }
 
                 int op_choice;
-                cout << "\n   [1] Allocate (Malloc)\n   [2] Deallocate (Free)\n   Choice: ";
+                cout << "\n   [1] Allocate (Malloc)\n   [2] Deallocate (Free)\n   [3] Bulk Allocate\n   [4] Bulk Free\n   Choice: ";
                 cin >> op_choice;
 
                 if (op_choice == 1) {
@@ -239,35 +351,26 @@ int main() {
                     cout << "   Bytes required: ";
                     cin >> bytes_needed;
 
-                    if (current_strategy == STRAT_UNSET) {
-                        int mode_sel;
-                        cout << "   Select Mode: [1] Linear (FF/BF/WF) [2] Buddy System: ";
-                        cin >> mode_sel;
-                        current_strategy = (mode_sel == 2) ? STRAT_BUDDY : STRAT_LINEAR;
-                        
-                
-                        cout << "Allocator mode set to " << (current_strategy == STRAT_BUDDY ? "BUDDY\n" : "LINEAR\n");
-                    }
+                    select_strategy_if_unset();
 
                     int result_addr = -1;
 
                     if (current_strategy == STRAT_BUDDY) {
                         result_addr = sys_buddy->buddy_malloc(bytes_needed);
                     } else {
-                        int lin_algo;
-                        cout << "   Algo: [1] FirstFit [2] BestFit [3] WorstFit: ";
-                        cin >> lin_algo;
+                        int lin_algo = prompt_linear_algo();
                         
                         if (lin_algo == 1) result_addr = malloc_first_fit(bytes_needed);
                         else if (lin_algo == 2) result_addr = malloc_best_fit(bytes_needed);
                         else if (lin_algo == 3) result_addr = malloc_worst_fit(bytes_needed);
+                        else if (lin_algo == 4) result_addr = malloc_tlsf(bytes_needed);
                     }
 
                     if (result_addr == -1) {
                         cout << "Allocation failed\n"; 
                     } else {
                         int blk_id = (current_strategy == STRAT_BUDDY) 
-                                     ? buddy_ids[result_addr] 
+                                     ? sys_buddy->get_block_id(result_addr) 
                                      : get_block_id(result_addr);
                         
                     
@@ -279,24 +382,84 @@ int main() {
                     cout << "   Block ID to free: ";
                     cin >> target_id;
 
-                    int addr_to_free = get_block_start_by_id(target_id);
-                    
-                    if (addr_to_free == -1) {
-                        for (auto &pair : buddy_ids) {
-                            if (pair.second == target_id) {
-                                addr_to_free = pair.first;
-                                break;
-                            }
-                        }
-                    }
+                    bool buddy_block = false;
+                    int addr_to_free = find_block_by_id(target_id, buddy_block);
 
                     if (addr_to_free != -1) {
-                        if (buddy_ids.count(addr_to_free)) sys_buddy->buddy_free(addr_to_free);
+                        if (buddy_block) sys_buddy->buddy_free(addr_to_free);
                         else free_block(addr_to_free);
                         cout << "Block " << target_id << " freed\n"; 
                     } else {
                         cout << "No block with id=" << target_id << "\n"; 
                     }
+
+                } else if (op_choice == 3) {
+                    int bytes_needed, block_count;
+                    cout << "   Bytes per block: ";
+                    cin >> bytes_needed;
+                    cout << "   Number of blocks: ";
+                    cin >> block_count;
+
+                    select_strategy_if_unset();
+
+                    vector<int> result_addrs;
+                    int served;
+
+                    if (current_strategy == STRAT_BUDDY) {
+                        served = sys_buddy->buddy_malloc_n(bytes_needed, block_count, result_addrs);
+                    } else {
+                        int lin_algo = prompt_linear_algo();
+                        if (lin_algo < FIT_FIRST || lin_algo > FIT_TLSF) {
+                            cout << "Allocation failed\n";
+                            break;
+                        }
+                        served = malloc_linear_n((LinearFit)lin_algo, bytes_needed, block_count, result_addrs);
+                    }
+
+                    for (int addr : result_addrs) {
+                        int blk_id = (current_strategy == STRAT_BUDDY)
+                                     ? sys_buddy->get_block_id(addr)
+                                     : get_block_id(addr);
+                        cout << "Allocated block id=" << blk_id << " at address=0x" << hex << addr << dec << "\n";
+                    }
+                    if (served < block_count)
+                        cout << "Allocation failed for " << (block_count - served) << " of " << block_count << " blocks\n";
+
+                } else if (op_choice == 4) {
+                    int block_count;
+                    cout << "   Number of blocks to free: ";
+                    cin >> block_count;
+                    cout << "   Block IDs: ";
+
+                    // Each id is queued once; the report is printed after the
+                    // batch so only blocks that were really released say freed.
+                    vector<int> target_ids(max(block_count, 0));
+                    vector<int> linear_addrs, buddy_addrs;
+                    unordered_set<int> queued;
+                    for (int &target_id : target_ids) {
+                        cin >> target_id;
+                        if (queued.count(target_id))
+                            continue;
+
+                        bool buddy_block = false;
+                        int addr_to_free = find_block_by_id(target_id, buddy_block);
+
+                        if (addr_to_free != -1) {
+                            (buddy_block ? buddy_addrs : linear_addrs).push_back(addr_to_free);
+                            queued.insert(target_id);
+                        }
+                    }
+
+                    if (!buddy_addrs.empty()) sys_buddy->buddy_free_n(buddy_addrs);
+                    if (!linear_addrs.empty()) free_block_n(linear_addrs);
+
+                    for (int target_id : target_ids) {
+                        bool buddy_block = false;
+                        if (queued.erase(target_id) && find_block_by_id(target_id, buddy_block) == -1)
+                            cout << "Block " << target_id << " freed\n";
+                        else
+                            cout << "No block with id=" << target_id << "\n";
+                    }
                 }
                 break;
             }
@@ -315,22 +478,28 @@ int main() {
 
                     switch(vm_act) {
                         case 1: { 
-                            int p, v;
+                            int p;
+                            long long v;
                             cout << "   PID: "; cin >> p;
                             cout << "   Size: "; cin >> v;
-                            init_vm(p, v);
+                            if (init_vm(p, v))
+                                cout << "Virtual memory initialized for PID " << p << " of size: " << v << "B\n";
+                            else
+                                cout << "Error: Virtual size must be between 0 and " << MAX_VIRTUAL_SIZE << "B (48 bits).\n";
                             break;
                         }
-                        case 2: { 
-                            int p, vaddr;
+                        case 2:
+                        case 5: { 
+                            int p;
+                            long long vaddr;
                             cout << "   PID: "; cin >> p;
                             cout << "   Virtual Addr: "; cin >> vaddr;
-                            int phys = vm_access(p, vaddr);
+                            int phys = vm_access(p, vaddr, vm_act == 5);
                             if (phys == -1){
                                 cout << "Physical address = -1 (Error: Invalid PID or Segmentation Fault)\n";
                             }else{
                                 cout << "Physical address = " << phys << "\n";
-                                perform_memory_lookup(phys);
+                                perform_memory_lookup(p, phys, vm_act == 5 ? ACCESS_WRITE : ACCESS_READ);
                             }   
                             break;
                         }
@@ -343,6 +512,58 @@ int main() {
                         case 4: 
                             stay_in_vm = false; 
                             break;
+                        case 6: {
+                            int policy;
+                            cout << "   Policy: [1] LRU [2] FIFO [3] Clock [4] Enhanced Clock [5] LFU (aging) [6] ARC [7] OPT: ";
+                            cin >> policy;
+                            if (policy == PR_OPT) {
+                                cout << "OPT needs the whole reference string in advance; replay a trace with ./page_sim.\n";
+                            } else if (policy < PR_LRU || policy > PR_ARC) {
+                                cout << "Invalid policy.\n";
+                            } else {
+                                set_page_replacement(make_page_replacer((PageReplacementPolicy)policy));
+                                cout << "Page replacement policy set to " << page_replacement_name() << "\n";
+                            }
+                            break;
+                        }
+                        case 7: {
+                            int levels, asids;
+                            cout << "   Number of TLB Levels (0 to disable): ";
+                            cin >> levels;
+                            if (levels < 0 || levels > 4) {
+                                cout << "Error: Use between 0 and 4 TLB levels.\n";
+                                break;
+                            }
+
+                            vector<Tlb> tlbs;
+                            bool valid = true;
+                            for (int k = 0; k < levels; k++) {
+                                int entries, ways, latency;
+                                cout << "   L" << k + 1 << " TLB (Entries Assoc Latency): ";
+                                cin >> entries >> ways >> latency;
+                                if (entries <= 0 || ways <= 0 || entries % ways != 0 || latency < 0)
+                                    valid = false;
+                                else
+                                    tlbs.push_back(Tlb(entries, ways, latency));
+                            }
+                            cout << "   ASID Tagging: [0] Off (flush on switch) [1] On: ";
+                            cin >> asids;
+                            if (!valid) {
+                                cout << "Error: Each TLB needs Entries a positive multiple of Assoc.\n";
+                                break;
+                            }
+
+                            configure_tlb(tlbs, asids != 0);
+                            if (levels == 0) {
+                                cout << "TLB disabled.\n";
+                                break;
+                            }
+                            for (int k = 0; k < levels; k++)
+                                cout << "L" << k + 1 << " TLB: " << tlbs[k].get_entries() << " entries | Assoc: "
+                                     << tlbs[k].get_ways() << "-way | Latency: " << tlbs[k].get_latency() << "\n";
+                            cout << "ASID Tagging: " << (asids ? "On" : "Off") << "\n";
+                            break;
+                        }
                         default:
                             cout << "Invalid VM choice.\n";
                     }
@@ -352,7 +573,7 @@ int main() {
 
             case 4: {
                 int stat_choice;
-                cout << "\n   [1] Visual Map (Dump)\n   [2] Detailed Stats\n   Choice: ";
+                cout << "\n   [1] Visual Map (Dump)\n   [2] Detailed Stats\n   [3] Export Per-Set Cache Histogram\n   Choice: ";
                 cin >> stat_choice;
                 
                 if (stat_choice == 1) {
@@ -364,6 +585,17 @@ int main() {
                         cout << "Linear allocator in use \n";
                         dump_memory();
                     }
+                } else if (stat_choice == 3) {
+                    string path;
+                    cout << "   Output File: ";
+                    cin >> path;
+                    ofstream out(path);
+                    if (!cache_system || coherent_system || !cache_system->write_set_histogram(out))
+                        cout << "Error: Enable per-set statistics with [6] Configure Cache Hierarchy first.\n";
+                    else if (!out)
+                        cout << "Error: Cannot write " << path << "\n";
+                    else
+                        cout << "Per-set histogram written to " << path << "\n";
                 } else {
                     print_system_report();
                 }
@@ -373,8 +605,146 @@ int main() {
             
             case 5:
                 cout << "Shutting down simulator.\n";
+                event_sink->flush();
                 return 0;
 
+            case 6: {
+                if (config_ram_size == 0) {
+                    cout << "Alert: Initialize system first.\n";
+                    break;
+                }
+
+                int level_count, incl, mem_latency, write_pol, write_alloc, set_stats;
+                cout << "\n>> Number of Cache Levels: ";
+                cin >> level_count;
+                if (level_count < 1) {
+                    cout << "Error: At least one cache level is required.\n";
+                    break;
+                }
+
+                vector<int> sizes(level_count), blocks(level_count), ways(level_count);
+                vector<int> latencies(level_count), policies(level_count), prefetchers(level_count);
+                vector<int> victim_entries(level_count);
+                for (int k = 0; k < level_count; k++) {
+                    cout << ">> L" << k + 1 << " Cache (Size BlockSize Assoc Latency): ";
+                    cin >> sizes[k] >> blocks[k] >> ways[k] >> latencies[k];
+                    cout << "   Policy: [1] FIFO [2] LRU [3] TreePLRU [4] SRRIP [5] Random: ";
+                    cin >> policies[k];
+                    cout << "   Prefetcher: [0] None [1] Next-Line [2] Stride [3] Stream Buffer: ";
+                    cin >> prefetchers[k];
+                    cout << "   Victim Cache Entries (0 for none): ";
+                    cin >> victim_entries[k];
+                }
+                cout << ">> Inclusion: [1] NINE [2] Inclusive [3] Exclusive: ";
+                cin >> incl;
+                cout << ">> Write Policy: [1] Write-Back [2] Write-Through: ";
+                cin >> write_pol;
+                cout << ">> Write Miss: [1] Write-Allocate [2] No-Write-Allocate: ";
+                cin >> write_alloc;
+                cout << ">> Main Memory Latency (cycles): ";
+                cin >> mem_latency;
+                cout << ">> Per-Set Miss Statistics: [0] Off [1] On: ";
+                cin >> set_stats;
+
+                bool valid = true;
+                for (int k = 0; k < level_count; k++)
+                    if (sizes[k] <= 0 || blocks[k] <= 0 || ways[k] <= 0 || sizes[k] < (long long)blocks[k] * ways[k])
+                        valid = false;
+                if (!valid) {
+                    cout << "Error: Each level needs Size >= BlockSize * Assoc > 0.\n";
+                    break;
+                }
+                for (int k = 0; k < level_count; k++)
+                    if (ways[k] > MAX_CACHE_WAYS)
+                        valid = false;
+                if (!valid) {
+                    cout << "Error: Associativity must be at most " << MAX_CACHE_WAYS << " ways.\n";
+                    break;
+                }
+                for (int k = 0; k < level_count; k++)
+                    if (victim_entries[k] < 0 || victim_entries[k] > 64)
+                        valid = false;
+                if (!valid) {
+                    cout << "Error: Victim caches hold at most 64 entries.\n";
+                    break;
+                }
+                if (incl < INCL_NINE || incl > INCL_EXCLUSIVE) incl = INCL_NINE;
+                if (write_pol != WRITE_THROUGH) write_pol = WRITE_BACK;
+                if (write_alloc != NO_WRITE_ALLOCATE) write_alloc = WRITE_ALLOCATE;
+
+                delete cache_system;
+                delete coherent_system;
+                coherent_system = nullptr;
+                cache_system = new CacheHierarchy((InclusionPolicy)incl, mem_latency);
+                cache_system->set_write_policy((WritePolicy)write_pol, (WriteMissPolicy)write_alloc);
+                for (int k = 0; k < level_count; k++) {
+                    int policy = (policies[k] >= POLICY_FIFO && policies[k] <= POLICY_RANDOM) ? policies[k] : POLICY_FIFO;
+                    cache_system->add_level(make_cache_level((CachePolicy)policy, sizes[k], blocks[k], ways[k]), latencies[k]);
+                    if (prefetchers[k] >= PF_NEXT_LINE && prefetchers[k] <= PF_STREAM)
+                        cache_system->set_prefetcher(k, make_prefetcher((PrefetchKind)prefetchers[k], blocks[k]));
+                    cache_system->set_victim_cache(k, victim_entries[k]);
+                }
+                if (set_stats == 1)
+                    cache_system->enable_set_stats();
+                custom_cache_config = true;
+                total_cycles = 0;
+
+                cout << "\n[System] Cache Hierarchy Configured (" << inclusion_name((InclusionPolicy)incl) << ").\n";
+                for (int k = 0; k < level_count; k++)
+                    cout << "L" << k + 1 << " Size: " << sizes[k] << "B | Block Size:" << blocks[k]
+                         << "B | Assoc: " << ways[k] << "-way | Latency: " << latencies[k]
+                         << " | Policy: " << cache_system->level(k).policy_name()
+                         << " | Prefetcher: " << cache_system->prefetcher_name(k)
+                         << " | Victim Cache: " << victim_entries[k] << "\n";
+                cout << "Write Policy: " << write_policy_name((WritePolicy)write_pol) << ", "
+                     << write_miss_name((WriteMissPolicy)write_alloc) << "\n";
+                cout << "Main Memory Latency: " << mem_latency << "\n";
+                break;
+            }
+
+            case 7: {
+                if (config_ram_size == 0) {
+                    cout << "Alert: Initialize system first.\n";
+                    break;
+                }
+
+                int cores, l1_size, block, l1_ways, llc_size, llc_ways, proto;
+                cout << "\n>> Number of Cores (1-64): ";
+                cin >> cores;
+                cout << ">> Private L1 per Core (Size BlockSize Assoc): ";
+                cin >> l1_size >> block >> l1_ways;
+                cout << ">> Shared LLC (Size Assoc): ";
+                cin >> llc_size >> llc_ways;
+                cout << ">> Protocol: [1] MESI [2] MOESI: ";
+                cin >> proto;
+
+                if (cores < 1 || cores > 64) {
+                    cout << "Error: Core count must be between 1 and 64.\n";
+                    break;
+                }
+                if (block <= 0 || l1_ways <= 0 || llc_ways <= 0 ||
+                    l1_size < (long long)block * l1_ways || llc_size < (long long)block * llc_ways) {
+                    cout << "Error: Each cache needs Size >= BlockSize * Assoc > 0.\n";
+                    break;
+                }
+                if (l1_ways > MAX_CACHE_WAYS || llc_ways > MAX_CACHE_WAYS) {
+                    cout << "Error: Associativity must be at most " << MAX_CACHE_WAYS << " ways.\n";
+                    break;
+                }
+                if (proto != PROTO_MOESI) proto = PROTO_MESI;
+
+                delete coherent_system;
+                coherent_system = new CoherentSystem(cores, l1_size, block, l1_ways,
+                                                     llc_size, llc_ways, (CoherenceProtocol)proto);
+                total_cycles = 0;
+
+                cout << "\n[System] Multi-Core Mode Enabled (" << protocol_name((CoherenceProtocol)proto) << ").\n";
+                cout << "Cores: " << cores << " (PID n runs on core n % " << cores << ")\n";
+                cout << "L1 per Core Size: " << l1_size << "B | Block Size:" << block << "B | Assoc: " << l1_ways << "-way\n";
+                cout << "Shared LLC Size: " << llc_size << "B | Block Size:" << block << "B | Assoc: " << llc_ways << "-way\n";
+                break;
+            }
+
             default:
                 cout << "Unknown selection.\n";
         }
@@ -1,10 +1,12 @@
-#include <list>
 #include <vector>
 #include <iostream>
 #include <iomanip>
 #include "../include/memory.h"
 #include "../include/buddy.h"
 #include <sstream>
+#include <map>
+#include <cstdint>
+#include <algorithm>
 using namespace std;
 
 int total_alloc_requests = 0;
@@ -14,11 +16,310 @@ int total_memory_size = 0;
 
 int next_block_id = 1;
 
-unordered_map<int,int> buddy_ids;
-list<Block> memory_blocks;
+BlockList memory_blocks;
+
+typedef BlockList::iterator BlockIter;
+
+BlockList::iterator BlockList::insert(iterator before, const Block &b) {
+    int slot;
+    if (!unused_slots.empty()) {
+        slot = unused_slots.back();
+        unused_slots.pop_back();
+        blocks[slot] = b;
+    } else {
+        slot = (int)blocks.size();
+        blocks.push_back(b);
+        next_slot.push_back(-1);
+        prev_slot.push_back(-1);
+    }
+
+    int after = before.slot();
+    int prev = (after == -1) ? tail : prev_slot[after];
+
+    next_slot[slot] = after;
+    prev_slot[slot] = prev;
+    if (prev == -1) head = slot; else next_slot[prev] = slot;
+    if (after == -1) tail = slot; else prev_slot[after] = slot;
+
+    count++;
+    return iterator(this, slot);
+}
+
+BlockList::iterator BlockList::erase(iterator it) {
+    int slot = it.slot();
+    int prev = prev_slot[slot];
+    int after = next_slot[slot];
+
+    if (prev == -1) head = after; else next_slot[prev] = after;
+    if (after == -1) tail = prev; else prev_slot[after] = prev;
+
+    unused_slots.push_back(slot);
+    count--;
+    return iterator(this, after);
+}
+
+void BlockList::clear() {
+    blocks.clear();
+    next_slot.clear();
+    prev_slot.clear();
+    unused_slots.clear();
+    head = tail = -1;
+    count = 0;
+}
+
+// Free blocks ordered by (size, start): best fit is a lower_bound and worst
+// fit the last size class, with ties resolved towards the lowest address
+// exactly like the original linear scans.
+static map<pair<int,int>, BlockIter> free_by_size;
+
+// TLSF: free blocks are also bucketed into segregated lists by a first level
+// (power of two) and second level (TLSF_SL_COUNT linear subdivisions) index.
+// A bit is set in the bitmaps whenever the matching list is non-empty.
+const int TLSF_SL_LOG2 = 4;
+const int TLSF_SL_COUNT = 1 << TLSF_SL_LOG2;
+const int TLSF_FL_COUNT = 32;
+
+static uint32_t tlsf_fl_bitmap = 0;
+static uint32_t tlsf_sl_bitmap[TLSF_FL_COUNT];
+static int tlsf_heads[TLSF_FL_COUNT][TLSF_SL_COUNT];
+
+// Segregated lists are threaded through the block slots, indexed by slot.
+static vector<int> tlsf_next;
+static vector<int> tlsf_prev;
+
+static int tlsf_fls(uint32_t x) {
+    return 31 - __builtin_clz(x);
+}
+
+static void tlsf_mapping(int size, int &fl, int &sl) {
+    if (size < TLSF_SL_COUNT) {
+        fl = 0;
+        sl = size;
+    } else {
+        int f = tlsf_fls(size);
+        fl = f - TLSF_SL_LOG2 + 1;
+        sl = (size >> (f - TLSF_SL_LOG2)) - TLSF_SL_COUNT;
+    }
+}
+
+static void tlsf_insert(BlockIter it) {
+    int fl, sl;
+    tlsf_mapping(it->size, fl, sl);
+
+    int slot = it.slot();
+    if (slot >= (int)tlsf_next.size()) {
+        tlsf_next.resize(2 * slot + 1, -1);
+        tlsf_prev.resize(2 * slot + 1, -1);
+    }
+
+    int &head = tlsf_heads[fl][sl];
+    tlsf_prev[slot] = -1;
+    tlsf_next[slot] = head;
+    if (head != -1)
+        tlsf_prev[head] = slot;
+    head = slot;
+
+    tlsf_fl_bitmap |= 1u << fl;
+    tlsf_sl_bitmap[fl] |= 1u << sl;
+}
+
+static void tlsf_remove(BlockIter it) {
+    int fl, sl;
+    tlsf_mapping(it->size, fl, sl);
+
+    int slot = it.slot();
+    int &head = tlsf_heads[fl][sl];
+    if (tlsf_prev[slot] != -1)
+        tlsf_next[tlsf_prev[slot]] = tlsf_next[slot];
+    else
+        head = tlsf_next[slot];
+    if (tlsf_next[slot] != -1)
+        tlsf_prev[tlsf_next[slot]] = tlsf_prev[slot];
+
+    if (head == -1) {
+        tlsf_sl_bitmap[fl] &= ~(1u << sl);
+        if (!tlsf_sl_bitmap[fl])
+            tlsf_fl_bitmap &= ~(1u << fl);
+    }
+}
+
+// Rounds the request up to the next list boundary so that any block in the
+// list found is guaranteed to fit, then uses find-first-set on the bitmaps.
+static bool tlsf_find(int size, BlockIter &out) {
+    int fl, sl;
+    int64_t rounded = size;
+    if (size >= TLSF_SL_COUNT)
+        rounded += (1 << (tlsf_fls(size) - TLSF_SL_LOG2)) - 1;
+    if (rounded > INT32_MAX)
+        return false;
+    tlsf_mapping((int)rounded, fl, sl);
+
+    uint32_t sl_map = tlsf_sl_bitmap[fl] & (~0u << sl);
+    if (!sl_map) {
+        uint32_t fl_map = tlsf_fl_bitmap & (~0u << (fl + 1));
+        if (!fl_map)
+            return false;
+        fl = __builtin_ctz(fl_map);
+        sl_map = tlsf_sl_bitmap[fl];
+    }
+    sl = __builtin_ctz(sl_map);
+
+    out = BlockIter(&memory_blocks, tlsf_heads[fl][sl]);
+    return true;
+}
+
+static void tlsf_reset() {
+    tlsf_fl_bitmap = 0;
+    for (int fl = 0; fl < TLSF_FL_COUNT; fl++) {
+        tlsf_sl_bitmap[fl] = 0;
+        for (int &head : tlsf_heads[fl])
+            head = -1;
+    }
+    tlsf_next.clear();
+    tlsf_prev.clear();
+}
+
+// One bit per slot, set while the slot holds an indexed free block, so first
+// fit can skip 64 used slots per word instead of walking the address chain.
+static vector<uint64_t> free_slot_mask;
+
+// Running total of free bytes; the largest free block is the last entry of
+// free_by_size, so fragmentation and utilization queries need no walk.
+static int free_bytes = 0;
+
+static void index_free(BlockIter it) {
+    free_by_size[{it->size, it->start}] = it;
+    tlsf_insert(it);
+    free_bytes += it->size;
+
+    int slot = it.slot();
+    if (slot / 64 >= (int)free_slot_mask.size())
+        free_slot_mask.resize(2 * (slot / 64) + 1, 0);
+    free_slot_mask[slot / 64] |= 1ull << (slot % 64);
+}
+
+static void unindex_free(BlockIter it) {
+    free_by_size.erase({it->size, it->start});
+    tlsf_remove(it);
+    free_bytes -= it->size;
+
+    int slot = it.slot();
+    free_slot_mask[slot / 64] &= ~(1ull << (slot % 64));
+}
+
+// Allocated blocks keyed by start address, and block ids back to their start,
+// so frees and id lookups no longer walk memory_blocks.
+static unordered_map<int, BlockIter> used_blocks;
+static unordered_map<int,int> id_to_start;
+
+// Splits `count` consecutive blocks of `size` bytes off the front of the free
+// block `it`, touching the free indexes once for the whole run.
+static int carve_run(BlockIter it, int size, int count, vector<int> *out) {
+    unindex_free(it);
+
+    int total = size * count;
+    if (it->size > total) {
+        Block remaining{it->start + total,
+                        it->size - total,
+                        true,
+                        -1};
+
+        index_free(memory_blocks.insert(next(it), remaining));
+    }
+
+    int first = it->start;
+    it->size = size;
+
+    for (int i = 0; i < count; i++) {
+        if (i > 0)
+            it = memory_blocks.insert(next(it), Block{first + i * size, size, false, -1});
+
+        it->free = false;
+        it->id = next_block_id++;
+        used_blocks[it->start] = it;
+        id_to_start[it->id] = it->start;
+
+        if (out)
+            out->push_back(it->start);
+    }
+
+    successful_allocs += count;
+    return first;
+}
+
+static int allocate_from(BlockIter it, int size) {
+    return carve_run(it, size, 1, nullptr);
+}
+
+// Slots are not in address order, so every free block is visited and the
+// lowest start that fits wins, exactly as the old address-ordered walk.
+static BlockIter find_first_fit(int size) {
+    BlockIter best = memory_blocks.end();
+    if (largest_free_block() < size)
+        return best;
+
+    for (size_t w = 0; w < free_slot_mask.size(); w++) {
+        for (uint64_t bits = free_slot_mask[w]; bits; bits &= bits - 1) {
+            BlockIter it(&memory_blocks, (int)(w * 64 + __builtin_ctzll(bits)));
+            if (it->size >= size && (best == memory_blocks.end() || it->start < best->start))
+                best = it;
+        }
+    }
+    return best;
+}
+
+static BlockIter find_best_fit(int size) {
+    auto fit = free_by_size.lower_bound({size, 0});
+    return (fit == free_by_size.end()) ? memory_blocks.end() : fit->second;
+}
+
+static BlockIter find_worst_fit(int size) {
+    int largest = largest_free_block();
+    if (largest < size)
+        return memory_blocks.end();
+    return free_by_size.lower_bound({largest, 0})->second;
+}
+
+static BlockIter find_tlsf(int size) {
+    BlockIter fit;
+    return tlsf_find(size, fit) ? fit : memory_blocks.end();
+}
+
+static BlockIter find_fit(LinearFit fit, int size) {
+    switch (fit) {
+        case FIT_FIRST: return find_first_fit(size);
+        case FIT_BEST:  return find_best_fit(size);
+        case FIT_WORST: return find_worst_fit(size);
+        case FIT_TLSF:  return find_tlsf(size);
+    }
+    return memory_blocks.end();
+}
+
+static int linear_malloc(LinearFit fit, int size) {
+    total_alloc_requests++;
+    if (size <= 0) {
+        cout << "Invalid allocation size\n";
+        failed_allocs++;
+        return -1;
+    }
+
+    auto it = find_fit(fit, size);
+    if (it == memory_blocks.end()) {
+        failed_allocs++;
+        return -1;
+    }
+
+    return allocate_from(it, size);
+}
 
 void init_memory(int total_size) {
     memory_blocks.clear();
+    free_by_size.clear();
+    tlsf_reset();
+    free_slot_mask.clear();
+    free_bytes = 0;
+    used_blocks.clear();
+    id_to_start.clear();
     total_memory_size = total_size;
     next_block_id = 1;
 
@@ -29,6 +330,7 @@ void init_memory(int total_size) {
     initial.id = -1;
 
     memory_blocks.push_back(initial);
+    index_free(memory_blocks.begin());
 }
 
 void reset_allocation_stats() {
@@ -59,189 +361,159 @@ void dump_memory() {
 }
 
 int malloc_first_fit(int size) {
-    total_alloc_requests++;
-    if (size <= 0) {
-        cout << "Invalid allocation size\n";
-        failed_allocs++;
-        return -1;
-    }
-
-    for (auto it = memory_blocks.begin(); it != memory_blocks.end(); ++it) {
-
-        if (it->free && it->size >= size) {
-
-            int alloc_start = it->start;
-
-            if (it->size == size) {
-                it->free = false;
-                it->id = next_block_id++;
-            } else {
-                Block allocated{it->start, size, false, next_block_id++};
-                Block remaining{it->start + size,
-                                it->size - size,
-                                true,
-                                -1};
-
-                it = memory_blocks.erase(it);
-                it = memory_blocks.insert(it, allocated);
-                ++it;
-                memory_blocks.insert(it, remaining);
-            }
-
-            successful_allocs++;
-            return alloc_start;
-        }
-    }
-
-    failed_allocs++;
-    return -1;
+    return linear_malloc(FIT_FIRST, size);
 }
 
 void free_block(int start_address) {
-    for (auto it = memory_blocks.begin(); it != memory_blocks.end(); ++it) {
-
-        if (it->start == start_address && !it->free) {
-
-            it->free = true;
-            it->id = -1;
-
-            if (it != memory_blocks.begin()) {
-                auto prev = it;
-                --prev;
-                if (prev->free) {
-                    prev->size += it->size;
-                    it = memory_blocks.erase(it);
-                    it = prev;
-                }
-            }
-
-            auto next = it;
-            ++next;
-            if (next != memory_blocks.end() && next->free) {
-                it->size += next->size;
-                memory_blocks.erase(next);
-            }
-
-            return;
-        }
-    }
-}
-
-int malloc_best_fit(int size) {
-    total_alloc_requests++;
-    if (size <= 0) {
-        cout << "Invalid allocation size\n";
-        failed_allocs++;
-        return -1;
-    }
-
-    auto best = memory_blocks.end();
-
-    for (auto it = memory_blocks.begin(); it != memory_blocks.end(); ++it) {
-        if (it->free && it->size >= size) {
-            if (best == memory_blocks.end() || it->size < best->size)
-                best = it;
+    auto found = used_blocks.find(start_address);
+    if (found == used_blocks.end())
+        return;
+
+    auto it = found->second;
+    used_blocks.erase(found);
+    id_to_start.erase(it->id);
+
+    it->free = true;
+    it->id = -1;
+
+    if (it != memory_blocks.begin()) {
+        auto prev = it;
+        --prev;
+        if (prev->free) {
+            unindex_free(prev);
+            prev->size += it->size;
+            it = memory_blocks.erase(it);
+            it = prev;
         }
     }
 
-    if (best == memory_blocks.end()) {
-        failed_allocs++;
-        return -1;
+    auto next = it;
+    ++next;
+    if (next != memory_blocks.end() && next->free) {
+        unindex_free(next);
+        it->size += next->size;
+        memory_blocks.erase(next);
     }
 
-    int alloc_start = best->start;
+    index_free(it);
+}
 
-    if (best->size == size) {
-        best->free = false;
-        best->id = next_block_id++;
-    } else {
-        Block allocated{best->start, size, false, next_block_id++};
-        Block remaining{best->start + size,
-                        best->size - size,
-                        true,
-                        -1};
+int malloc_best_fit(int size) {
+    return linear_malloc(FIT_BEST, size);
+}
 
-        best = memory_blocks.erase(best);
-        best = memory_blocks.insert(best, allocated);
-        ++best;
-        memory_blocks.insert(best, remaining);
-    }
+int malloc_worst_fit(int size) {
+    return linear_malloc(FIT_WORST, size);
+}
 
-    successful_allocs++;
-    return alloc_start;
+int malloc_tlsf(int size) {
+    return linear_malloc(FIT_TLSF, size);
 }
 
-int malloc_worst_fit(int size) {
-    total_alloc_requests++;
+// Serves a burst of equal-size requests from a single hole when one is large
+// enough for all of them, otherwise falls back to one placement per request.
+int malloc_linear_n(LinearFit fit, int size, int count, vector<int> &out) {
+    if (count <= 0)
+        return 0;
+
+    total_alloc_requests += count;
     if (size <= 0) {
         cout << "Invalid allocation size\n";
-        failed_allocs++;
-        return -1;
+        failed_allocs += count;
+        return 0;
     }
 
-    auto worst = memory_blocks.end();
-
-    for (auto it = memory_blocks.begin(); it != memory_blocks.end(); ++it) {
-        if (it->free && it->size >= size) {
-            if (worst == memory_blocks.end() || it->size > worst->size)
-                worst = it;
+    long long run = (long long)size * count;
+    if (run <= largest_free_block()) {
+        auto it = find_fit(fit, (int)run);
+        if (it != memory_blocks.end()) {
+            carve_run(it, size, count, &out);
+            return count;
         }
     }
 
-    if (worst == memory_blocks.end()) {
-        failed_allocs++;
-        return -1;
+    int served = 0;
+    while (served < count) {
+        auto it = find_fit(fit, size);
+        if (it == memory_blocks.end())
+            break;
+        out.push_back(allocate_from(it, size));
+        served++;
     }
 
-    int alloc_start = worst->start;
+    failed_allocs += count - served;
+    return served;
+}
+
+// Frees a batch of blocks in address order. Adjacent frees are merged into a
+// single pending run that is indexed once, instead of being inserted into and
+// removed from the free indexes on every step.
+void free_block_n(vector<int> addrs) {
+    if (!is_sorted(addrs.begin(), addrs.end()))
+        sort(addrs.begin(), addrs.end());
+
+    BlockIter open = memory_blocks.end();
+
+    for (int addr : addrs) {
+        auto found = used_blocks.find(addr);
+        if (found == used_blocks.end())
+            continue;
+
+        auto it = found->second;
+        used_blocks.erase(found);
+        id_to_start.erase(it->id);
+
+        it->free = true;
+        it->id = -1;
+
+        if (it != memory_blocks.begin()) {
+            auto prev = it;
+            --prev;
+            if (prev->free) {
+                if (prev != open)
+                    unindex_free(prev);
+                prev->size += it->size;
+                memory_blocks.erase(it);
+                it = prev;
+            }
+        }
 
-    if (worst->size == size) {
-        worst->free = false;
-        worst->id = next_block_id++;
-    } else {
-        Block allocated{worst->start, size, false, next_block_id++};
-        Block remaining{worst->start + size,
-                        worst->size - size,
-                        true,
-                        -1};
+        if (open != memory_blocks.end() && open != it)
+            index_free(open);
+        open = it;
 
-        worst = memory_blocks.erase(worst);
-        worst = memory_blocks.insert(worst, allocated);
-        ++worst;
-        memory_blocks.insert(worst, remaining);
+        auto next = it;
+        ++next;
+        if (next != memory_blocks.end() && next->free) {
+            unindex_free(next);
+            it->size += next->size;
+            memory_blocks.erase(next);
+        }
     }
 
-    successful_allocs++;
-    return alloc_start;
+    if (open != memory_blocks.end())
+        index_free(open);
 }
 
 int internal_fragmentation() {
     return 0;  
 }
 
-int external_fragmentation() {
-    int total_free = 0;
-    int max_free = 0;
+int free_memory() {
+    return free_bytes;
+}
 
-    for (auto &b : memory_blocks) {
-        if (b.free) {
-            total_free += b.size;
-            max_free = max(max_free, b.size);
-        }
-    }
+int largest_free_block() {
+    return free_by_size.empty() ? 0 : free_by_size.rbegin()->first.first;
+}
 
-    return total_free - max_free;
+int external_fragmentation() {
+    return free_bytes - largest_free_block();
 }
 
 double memory_utilization() {
-    int used = 0, total = 0;
-
-    for (auto &b : memory_blocks) {
-        total += b.size;
-        if (!b.free) used += b.size;
-    }
-    
-    return total ? (used * 100.0 / total) : 0.0;
+    int used = total_memory_size - free_bytes;
+    return total_memory_size ? (used * 100.0 / total_memory_size) : 0.0;
 }
 
 void allocation_stats() {
@@ -257,17 +529,11 @@ void allocation_stats() {
 }
 
 int get_block_id(int start_address) {
-    for (auto &b : memory_blocks) {
-        if (!b.free && b.start == start_address)
-            return b.id;
-    }
-    return -1;
+    auto it = used_blocks.find(start_address);
+    return (it == used_blocks.end()) ? -1 : it->second->id;
 }
 
 int get_block_start_by_id(int id) {
-    for (auto &b : memory_blocks) {
-        if (!b.free && b.id == id)
-            return b.start;
-    }
-    return -1;
+    auto it = id_to_start.find(id);
+    return (it == id_to_start.end()) ? -1 : it->second;
 }
\ No newline at end of file
@@ -0,0 +1,319 @@
+#include "../include/page_replacement.h"
+#include <algorithm>
+#include <climits>
+
+using namespace std;
+
+// ---- LRU ----
+
+void LruReplacer::reset(int frames) {
+    prev.assign(frames, -1);
+    next.assign(frames, -1);
+    head = tail = -1;
+}
+
+void LruReplacer::unlink(int f) {
+    if (prev[f] == -1 && head != f)
+        return;     // not in the list
+    (prev[f] == -1 ? head : next[prev[f]]) = next[f];
+    (next[f] == -1 ? tail : prev[next[f]]) = prev[f];
+    prev[f] = next[f] = -1;
+}
+
+void LruReplacer::push_front(int f) {
+    unlink(f);
+    next[f] = head;
+    if (head != -1)
+        prev[head] = f;
+    head = f;
+    if (tail == -1)
+        tail = f;
+}
+
+void LruReplacer::on_access(int frame, long long, bool) {
+    if (head != frame)
+        push_front(frame);
+}
+
+// ---- FIFO ----
+
+void FifoReplacer::reset(int frames) {
+    order.clear();
+    loaded.assign(frames, -1);
+    stamp = 0;
+}
+
+void FifoReplacer::on_load(int frame, long long, bool) {
+    loaded[frame] = stamp;
+    order.push_back({frame, stamp++});
+}
+
+int FifoReplacer::victim(long long) {
+    // Entries for frames freed or reloaded since are stale.
+    while (loaded[order.front().first] != order.front().second)
+        order.pop_front();
+    int f = order.front().first;
+    order.pop_front();
+    return f;
+}
+
+// ---- Clock ----
+
+void ClockReplacer::reset(int frames) {
+    referenced.assign(frames, 0);
+    hand = 0;
+}
+
+int ClockReplacer::victim(long long) {
+    int n = (int)referenced.size();
+    while (referenced[hand]) {
+        referenced[hand] = 0;
+        hand = (hand + 1) % n;
+    }
+    int f = hand;
+    hand = (hand + 1) % n;
+    return f;
+}
+
+// ---- Enhanced Clock ----
+
+void EnhancedClockReplacer::reset(int frames) {
+    referenced.assign(frames, 0);
+    dirty.assign(frames, 0);
+    hand = 0;
+}
+
+void EnhancedClockReplacer::on_load(int frame, long long, bool write) {
+    referenced[frame] = 1;
+    dirty[frame] = write;
+}
+
+void EnhancedClockReplacer::on_access(int frame, long long, bool write) {
+    referenced[frame] = 1;
+    if (write)
+        dirty[frame] = 1;
+}
+
+int EnhancedClockReplacer::victim(long long) {
+    int n = (int)referenced.size();
+    while (true) {
+        // First sweep: an unreferenced clean page, touching nothing.
+        for (int i = 0; i < n; i++) {
+            int f = hand;
+            hand = (hand + 1) % n;
+            if (!referenced[f] && !dirty[f])
+                return f;
+        }
+        // Second sweep: an unreferenced dirty page, clearing reference bits.
+        for (int i = 0; i < n; i++) {
+            int f = hand;
+            hand = (hand + 1) % n;
+            if (!referenced[f] && dirty[f])
+                return f;
+            referenced[f] = 0;
+        }
+    }
+}
+
+// ---- LFU with aging ----
+
+void AgingReplacer::reset(int n) {
+    frames = n;
+    count.assign(n, 0);
+    last_use.assign(n, -1);
+    order.clear();
+    clock = 0;
+    next_aging = (long long)AGING_PERIOD * n;
+}
+
+void AgingReplacer::age() {
+    order.clear();
+    for (int f = 0; f < frames; f++) {
+        if (last_use[f] == -1)
+            continue;
+        count[f] /= 2;
+        order.insert({{count[f], last_use[f]}, f});
+    }
+    next_aging = clock + (long long)AGING_PERIOD * frames;
+}
+
+void AgingReplacer::touch(int frame, bool fresh) {
+    clock++;
+    if (clock >= next_aging)
+        age();
+
+    if (last_use[frame] != -1)
+        order.erase({{count[frame], last_use[frame]}, frame});
+    count[frame] = fresh ? 1 : count[frame] + 1;
+    last_use[frame] = clock;
+    order.insert({{count[frame], last_use[frame]}, frame});
+}
+
+void AgingReplacer::on_free(int frame) {
+    if (last_use[frame] == -1)
+        return;
+    order.erase({{count[frame], last_use[frame]}, frame});
+    last_use[frame] = -1;
+}
+
+int AgingReplacer::victim(long long) {
+    return order.begin()->second;
+}
+
+// ---- ARC ----
+
+void ArcReplacer::reset(int frames) {
+    capacity = frames;
+    p = 0;
+    for (list<long long> &l : lists)
+        l.clear();
+    entries.clear();
+    page_of.assign(frames, -1);
+    frame_of.clear();
+    adapted = false;
+    discard_t1 = false;
+}
+
+void ArcReplacer::move_to(long long page, Where where) {
+    auto it = entries.find(page);
+    if (it != entries.end())
+        lists[it->second.where].erase(it->second.pos);
+    lists[where].push_front(page);
+    entries[page] = {where, lists[where].begin()};
+}
+
+void ArcReplacer::forget_lru(Where where) {
+    entries.erase(lists[where].back());
+    lists[where].pop_back();
+}
+
+// The part of a miss that does not depend on memory being full: adjust
+// the target size p on a ghost hit, or trim the ghost lists.
+void ArcReplacer::adapt(long long page) {
+    int t1 = (int)lists[T1].size(), t2 = (int)lists[T2].size();
+    int b1 = (int)lists[B1].size(), b2 = (int)lists[B2].size();
+
+    auto it = entries.find(page);
+    if (it != entries.end() && it->second.where == B1) {
+        p = min(capacity, p + max(b2 / b1, 1));
+    } else if (it != entries.end() && it->second.where == B2) {
+        p = max(0, p - max(b1 / b2, 1));
+    } else if (t1 + b1 == capacity) {
+        if (t1 < capacity)
+            forget_lru(B1);
+        else
+            discard_t1 = true;      // T1 alone fills memory: drop its LRU page
+    } else if (t1 + t2 + b1 + b2 >= capacity) {
+        if (t1 + t2 + b1 + b2 == 2 * capacity)
+            forget_lru(B2);
+    }
+    adapted = true;
+}
+
+int ArcReplacer::replace(long long page) {
+    auto it = entries.find(page);
+    bool in_b2 = it != entries.end() && it->second.where == B2;
+    int t1 = (int)lists[T1].size();
+
+    long long out;
+    if (discard_t1) {
+        out = lists[T1].back();
+        forget_lru(T1);
+        discard_t1 = false;
+    } else if (t1 > 0 && (t1 > p || (in_b2 && t1 == p) || lists[T2].empty())) {
+        out = lists[T1].back();
+        move_to(out, B1);
+    } else {
+        out = lists[T2].back();
+        move_to(out, B2);
+    }
+
+    int f = frame_of[out];
+    frame_of.erase(out);
+    page_of[f] = -1;
+    return f;
+}
+
+int ArcReplacer::victim(long long page) {
+    adapt(page);
+    return replace(page);
+}
+
+void ArcReplacer::on_load(int frame, long long page, bool) {
+    if (!adapted)
+        adapt(page);
+    adapted = false;
+
+    auto it = entries.find(page);
+    bool ghost = it != entries.end() && (it->second.where == B1 || it->second.where == B2);
+    move_to(page, ghost ? T2 : T1);
+    page_of[frame] = page;
+    frame_of[page] = frame;
+}
+
+void ArcReplacer::on_access(int, long long page, bool) {
+    move_to(page, T2);
+}
+
+void ArcReplacer::on_free(int frame) {
+    long long page = page_of[frame];
+    if (page == -1)
+        return;
+    auto it = entries.find(page);
+    lists[it->second.where].erase(it->second.pos);
+    entries.erase(it);
+    frame_of.erase(page);
+    page_of[frame] = -1;
+}
+
+// ---- OPT ----
+
+void OptReplacer::reset(int frames) {
+    t = 0;
+    due.assign(frames, -1);
+    order.clear();
+}
+
+void OptReplacer::set_due(int frame) {
+    if (due[frame] != -1)
+        order.erase({due[frame], frame});
+    due[frame] = t < next_use.size() ? next_use[t] : INT_MAX;
+    t++;
+    order.insert({due[frame], frame});
+}
+
+void OptReplacer::on_free(int frame) {
+    if (due[frame] == -1)
+        return;
+    order.erase({due[frame], frame});
+    due[frame] = -1;
+}
+
+int OptReplacer::victim(long long) {
+    return prev(order.end())->second;
+}
+
+vector<int> opt_next_use(const vector<long long> &refs) {
+    vector<int> next_use(refs.size());
+    unordered_map<long long, int> seen;
+    seen.reserve(refs.size());
+
+    for (int i = (int)refs.size() - 1; i >= 0; i--) {
+        auto it = seen.find(refs[i]);
+        next_use[i] = (it == seen.end()) ? (int)refs.size() : it->second;
+        seen[refs[i]] = i;
+    }
+    return next_use;
+}
+
+PageReplacer *make_page_replacer(PageReplacementPolicy policy) {
+    switch (policy) {
+        case PR_FIFO:           return new FifoReplacer();
+        case PR_CLOCK:          return new ClockReplacer();
+        case PR_ENHANCED_CLOCK: return new EnhancedClockReplacer();
+        case PR_AGING:          return new AgingReplacer();
+        case PR_ARC:            return new ArcReplacer();
+        case PR_LRU:            return new LruReplacer();
+        default:                return nullptr;
+    }
+}
@@ -0,0 +1,96 @@
+#include "../include/prefetch.h"
+#include <climits>
+
+using namespace std;
+
+// Drops candidates that fall outside the address space.
+static void emit(long long addr, vector<int> &out) {
+    if (addr >= 0 && addr <= INT_MAX)
+        out.push_back((int)addr);
+}
+
+void NextLinePrefetcher::observe(int block_addr, PrefetchOutcome outcome, vector<int> &out) {
+    if (outcome == PF_HIT)
+        return;
+    for (int i = 1; i <= degree; i++)
+        emit((long long)block_addr + (long long)i * block_size, out);
+}
+
+void StridePrefetcher::observe(int block_addr, PrefetchOutcome, vector<int> &out) {
+    clock++;
+    int region = block_addr >> REGION_BITS;
+
+    Region *entry = nullptr;
+    Region *lru = &table[0];
+    for (Region &r : table) {
+        if (r.region == region) {
+            entry = &r;
+            break;
+        }
+        if (r.last_use < lru->last_use)
+            lru = &r;
+    }
+
+    if (!entry) {
+        *lru = Region();
+        lru->region = region;
+        lru->last_block = block_addr;
+        lru->last_use = clock;
+        return;
+    }
+
+    int stride = block_addr - entry->last_block;
+    entry->last_use = clock;
+    entry->last_block = block_addr;
+    if (stride == 0)
+        return;
+
+    if (stride == entry->stride) {
+        if (entry->confidence < 3)
+            entry->confidence++;
+    } else {
+        entry->stride = stride;
+        entry->confidence = 0;
+    }
+
+    if (entry->confidence >= 1)
+        for (int i = 1; i <= degree; i++)
+            emit((long long)block_addr + (long long)i * stride, out);
+}
+
+void StreamBufferPrefetcher::observe(int block_addr, PrefetchOutcome outcome, vector<int> &out) {
+    clock++;
+    if (outcome == PF_HIT)
+        return;
+
+    if (outcome == PF_PREFETCH_HIT) {
+        for (Stream &s : streams) {
+            if (s.next != -1 && block_addr < s.next && block_addr >= s.next - depth * block_size) {
+                emit(s.next, out);
+                s.next = (s.next <= INT_MAX - block_size) ? s.next + block_size : -1;
+                s.last_use = clock;
+                return;
+            }
+        }
+    }
+
+    Stream *victim = &streams[0];
+    for (Stream &s : streams)
+        if (s.last_use < victim->last_use)
+            victim = &s;
+
+    for (int i = 1; i <= depth; i++)
+        emit((long long)block_addr + (long long)i * block_size, out);
+    long long next = (long long)block_addr + (long long)(depth + 1) * block_size;
+    victim->next = next <= INT_MAX ? (int)next : -1;
+    victim->last_use = clock;
+}
+
+Prefetcher *make_prefetcher(PrefetchKind kind, int block_size) {
+    switch (kind) {
+        case PF_NEXT_LINE: return new NextLinePrefetcher(block_size);
+        case PF_STRIDE:    return new StridePrefetcher(block_size);
+        case PF_STREAM:    return new StreamBufferPrefetcher(block_size);
+        default:           return nullptr;
+    }
+}
@@ -0,0 +1,45 @@
+#include "../include/set_stats.h"
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+
+vector<int> SetStats::hottest_sets(int count) const {
+    vector<int> order;
+    for (int s = 0; s < (int)sets.size(); s++)
+        if (sets[s].conflict > 0)
+            order.push_back(s);
+
+    count = min(count, (int)order.size());
+    partial_sort(order.begin(), order.begin() + count, order.end(), [this](int a, int b) {
+        if (sets[a].conflict != sets[b].conflict)
+            return sets[a].conflict > sets[b].conflict;
+        return a < b;
+    });
+    order.resize(count);
+    return order;
+}
+
+void SetStats::print_summary(const string &name) const {
+    cout << name << " Compulsory Misses: " << total.compulsory << "\n";
+    cout << name << " Capacity Misses: " << total.capacity << "\n";
+    cout << name << " Conflict Misses: " << total.conflict << "\n";
+
+    vector<int> hot = hottest_sets(3);
+    if (hot.empty())
+        return;
+    cout << name << " Conflict Hotspots:";
+    for (int s : hot)
+        cout << " set " << s << " (" << sets[s].conflict << ")";
+    cout << "\n";
+}
+
+void SetStats::write_histogram(ostream &out, const string &label) const {
+    for (int s = 0; s < (int)sets.size(); s++) {
+        const Counts &c = sets[s];
+        if (!label.empty())
+            out << label << ",";
+        out << s << "," << c.accesses << "," << c.misses << "," << c.compulsory
+            << "," << c.capacity << "," << c.conflict << "\n";
+    }
+}
@@ -0,0 +1,162 @@
+#include "../include/stack_distance.h"
+#include <algorithm>
+#include <unordered_map>
+#include <memory>
+
+using namespace std;
+
+void StackDistance::add(int p, int delta) {
+    for (; p < (int)tree.size(); p += p & -p)
+        tree[p] += delta;
+}
+
+int StackDistance::prefix(int p) const {
+    int sum = 0;
+    for (; p > 0; p -= p & -p)
+        sum += tree[p];
+    return sum;
+}
+
+// Renumbers the live positions 1..live_count in access order and resizes
+// the tree to twice that, so the next compaction is at least live_count
+// accesses away.
+void StackDistance::compact() {
+    int n = 0;
+    for (int p = 1; p < next_pos; p++) {
+        if (!live[p])
+            continue;
+        n++;
+        key_at[n] = key_at[p];
+        (*position)[key_at[n]] = n;
+    }
+
+    int cap = max(64, 2 * n);
+    key_at.resize(cap + 1);
+    live.assign(cap + 1, 0);
+    tree.assign(cap + 1, 0);
+    for (int p = 1; p <= cap; p++) {
+        if (p <= n) {
+            live[p] = 1;
+            tree[p] += 1;
+        }
+        int parent = p + (p & -p);
+        if (parent <= cap)
+            tree[parent] += tree[p];
+    }
+    next_pos = n + 1;
+}
+
+int StackDistance::access(int key) {
+    int distance = -1;
+
+    if (key >= (int)position->size())
+        position->resize(max(key + 1, 2 * (int)position->size()), -1);
+
+    int p = (*position)[key];
+    if (p != -1) {
+        distance = live_count - prefix(p);
+        add(p, -1);
+        live[p] = 0;
+        live_count--;
+    }
+
+    if (next_pos >= (int)tree.size())
+        compact();
+
+    p = next_pos++;
+    add(p, 1);
+    live[p] = 1;
+    key_at[p] = key;
+    (*position)[key] = p;
+    live_count++;
+    return distance;
+}
+
+void StackProfile::record(int distance) {
+    accesses++;
+    if (distance < 0) {
+        cold++;
+        return;
+    }
+    if (distance >= (int)hist.size())
+        hist.resize(max(distance + 1, 2 * (int)hist.size()), 0);
+    hist[distance]++;
+}
+
+long long StackProfile::hits(int blocks) const {
+    long long h = 0;
+    int end = min(blocks, (int)hist.size());
+    for (int d = 0; d < end; d++)
+        h += hist[d];
+    return h;
+}
+
+double StackProfile::hit_ratio(int blocks) const {
+    return accesses ? (double)hits(blocks) / accesses : 0.0;
+}
+
+// Renumbers the trace's block numbers as dense ids 0..distinct-1 and
+// returns the block number of each id in blocks.
+static vector<int> dense_block_ids(const vector<int> &trace, int block_size, vector<int> &blocks) {
+    unordered_map<int, int> id_of;
+    vector<int> ids(trace.size());
+
+    blocks.clear();
+    for (size_t i = 0; i < trace.size(); i++) {
+        int block = trace[i] / block_size;
+        auto ins = id_of.emplace(block, (int)blocks.size());
+        if (ins.second)
+            blocks.push_back(block);
+        ids[i] = ins.first->second;
+    }
+    return ids;
+}
+
+StackProfile profile_fully_associative(const vector<int> &trace, int block_size) {
+    vector<int> blocks;
+    vector<int> ids = dense_block_ids(trace, block_size, blocks);
+
+    vector<int> position(blocks.size(), -1);
+    StackDistance stack(&position);
+    StackProfile profile;
+
+    for (int id : ids)
+        profile.record(stack.access(id));
+    return profile;
+}
+
+SetAssocProfile profile_set_associative(const vector<int> &trace, int block_size,
+                                        int max_sets_log2, int max_tracked_sets) {
+    SetAssocProfile result;
+    result.block_size = block_size;
+    result.max_tracked_sets = max_tracked_sets;
+    result.profiles.resize(max_sets_log2 + 1);
+
+    vector<int> blocks;
+    vector<int> ids = dense_block_ids(trace, block_size, blocks);
+
+    // One stack per tracked set, for every set count, with one position
+    // table per set count. With stride > 1 only sets whose index is a
+    // multiple of the stride are tracked.
+    int levels = max_sets_log2 + 1;
+    vector<vector<int>> position(levels, vector<int>(blocks.size(), -1));
+    vector<vector<unique_ptr<StackDistance>>> stacks(levels);
+    vector<int> stride(levels);
+    for (int k = 0; k < levels; k++) {
+        int sets = 1 << k;
+        stride[k] = max(1, sets / max_tracked_sets);
+        for (int s = 0; s < sets / stride[k]; s++)
+            stacks[k].emplace_back(new StackDistance(&position[k]));
+    }
+
+    for (int id : ids) {
+        int block = blocks[id];
+        for (int k = 0; k < levels; k++) {
+            int set = block & ((1 << k) - 1);
+            if (set % stride[k])
+                continue;
+            result.profiles[k].record(stacks[k][set / stride[k]]->access(id));
+        }
+    }
+    return result;
+}
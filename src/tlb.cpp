@@ -0,0 +1,68 @@
+#include "../include/tlb.h"
+#include <iostream>
+
+using namespace std;
+
+Tlb::Tlb(int num_entries, int ways, int latency)
+    : num_sets(num_entries / ways), ways(ways), latency(latency), entries(num_entries) {}
+
+TlbEntry *Tlb::lookup(int asid, long long page) {
+    TlbEntry *set = set_of(page);
+    for (int w = 0; w < ways; w++) {
+        if (set[w].valid && set[w].page == page && set[w].asid == asid) {
+            hits++;
+            set[w].last_used = ++clock;
+            return &set[w];
+        }
+    }
+    misses++;
+    return nullptr;
+}
+
+void Tlb::insert(int asid, long long page, int frame, bool dirty) {
+    TlbEntry *set = set_of(page);
+    TlbEntry *slot = &set[0];
+    for (int w = 0; w < ways; w++) {
+        if (set[w].valid && set[w].page == page && set[w].asid == asid) {
+            slot = &set[w];
+            break;
+        }
+        // An invalid way wins; otherwise the least recently used one.
+        if (slot->valid && (!set[w].valid || set[w].last_used < slot->last_used))
+            slot = &set[w];
+    }
+    slot->valid = true;
+    slot->dirty = dirty;
+    slot->asid = asid;
+    slot->page = page;
+    slot->frame = frame;
+    slot->last_used = ++clock;
+}
+
+void Tlb::invalidate(int asid, long long page) {
+    TlbEntry *set = set_of(page);
+    for (int w = 0; w < ways; w++)
+        if (set[w].valid && set[w].page == page && set[w].asid == asid)
+            set[w].valid = false;
+}
+
+void Tlb::flush_asid(int asid) {
+    for (TlbEntry &e : entries)
+        if (e.asid == asid)
+            e.valid = false;
+}
+
+void Tlb::flush() {
+    for (TlbEntry &e : entries)
+        e.valid = false;
+}
+
+void Tlb::print_stats(const string &name) const {
+    long long accesses = hits + misses;
+    cout << name << " Accesses: " << accesses << "\n";
+    cout << name << " Hits: " << hits << "\n";
+    cout << name << " Misses: " << misses << "\n";
+
+    if (accesses > 0)
+        cout << name << " Hit Ratio: " << (hits * 100.0 / accesses) << "%\n";
+}
@@ -0,0 +1,91 @@
+#include "../include/trace.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <climits>
+
+using namespace std;
+
+static bool parse_address(const string &tok, long long &addr, long long max_addr) {
+    bool hex = tok.size() > 1 && tok[0] == '0' && (tok[1] == 'x' || tok[1] == 'X');
+    try {
+        size_t used;
+        long long v = stoll(tok, &used, hex ? 16 : 10);
+        if (used != tok.size() || v < 0 || v > max_addr)
+            return false;
+        addr = v;
+    } catch (const exception &) {
+        return false;
+    }
+    return true;
+}
+
+// Calls parse(line) for each non-blank, non-comment line; stops and reports
+// the line number on the first one it rejects.
+template <class F>
+static bool read_lines(const string &path, F parse) {
+    ifstream in(path);
+    if (!in) {
+        cerr << "Error: cannot open trace " << path << "\n";
+        return false;
+    }
+
+    string line;
+    int line_no = 0;
+    while (getline(in, line)) {
+        line_no++;
+
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == string::npos || line[start] == '#')
+            continue;
+
+        size_t end = line.find_last_not_of(" \t\r");
+        if (!parse(line.substr(start, end - start + 1))) {
+            cerr << "Error: bad record on line " << line_no << " of " << path << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool load_trace(const string &path, vector<int> &addresses) {
+    addresses.clear();
+    return read_lines(path, [&](const string &text) {
+        long long addr;
+        if (!parse_address(text, addr, INT_MAX))
+            return false;
+        addresses.push_back((int)addr);
+        return true;
+    });
+}
+
+bool load_core_trace(const string &path, vector<CoreAccess> &accesses) {
+    accesses.clear();
+    return read_lines(path, [&](const string &text) {
+        istringstream in(text);
+        string core, op, addr, extra;
+        if (!(in >> core >> op >> addr) || (in >> extra))
+            return false;
+
+        CoreAccess a;
+        try {
+            a.core = stoi(core);
+        } catch (const exception &) {
+            return false;
+        }
+        if (a.core < 0)
+            return false;
+
+        if (op == "R" || op == "r")
+            a.type = ACCESS_READ;
+        else if (op == "W" || op == "w")
+            a.type = ACCESS_WRITE;
+        else
+            return false;
+
+        if (!parse_address(addr, a.address, LLONG_MAX))
+            return false;
+        accesses.push_back(a);
+        return true;
+    });
+}
@@ -1,6 +1,11 @@
 #include "../include/vm.h"
+#include "../include/cache.h"
 #include <iostream>
 #include <unordered_map>
+#include <queue>
+#include <functional>
+#include <memory>
+#include <climits>
 
 using namespace std;
 
@@ -8,136 +13,386 @@ static int PAGE_SIZE;
 static int NUM_FRAMES;
 static int PHYSICAL_MEM_SIZE;
 
+// Each process's page table is a radix tree of 512-entry nodes, as on
+// x86-64, with just enough levels to cover its virtual size. Nodes are
+// allocated on first touch, so a sparse 48-bit space only pays for the
+// regions it uses. Inner nodes point to the next level; leaves hold PTEs.
+static const int PT_BITS = 9;
+static const int PT_FANOUT = 1 << PT_BITS;
+static const int PTE_BYTES = 8;     // simulated size of one entry
+
+struct PageTableNode {
+    int id;                                         // where the node sits in physical memory
+    vector<unique_ptr<PageTableNode>> children;     // inner nodes
+    vector<PageTableEntry> entries;                 // leaves
+};
+
 struct ProcessVM {
-    int num_pages;
-    vector<PageTableEntry> table;
+    long long num_pages = 0;
+    int levels = 1;
+    int slot = 0;               // dense per-process index for replacement keys
+    int resident = 0;           // frames in use
+    long long table_bytes = 0;  // host memory held by the nodes
+    unique_ptr<PageTableNode> root;
 };
 
 static unordered_map<int, ProcessVM> page_tables;
+static int next_slot = 0;
+static int next_node_id = 0;
+
+// Inverted frame table: who holds each frame. The replacement policy
+// keeps its own per-frame state and names the victim, so a fault never
+// scans the page tables.
+struct FrameEntry {
+    int pid;            // -1 when free
+    long long page;
+    long long key;      // the page's replacement key
+    PageTableEntry *pte;
+};
+
+static vector<FrameEntry> frame_table;
+static unique_ptr<PageReplacer> replacer(new LruReplacer());
 
-static vector<int> frame_owner;   
+// Free frames, lowest first.
+static priority_queue<int, vector<int>, greater<int>> free_frames;
+
+// TLB levels, L1 first. An entry is dropped when its page is evicted or
+// its process re-initialised, so a TLB hit never names a stale frame.
+static vector<Tlb> tlbs;
+static bool tlb_asids = true;
+static int tlb_last_pid = -1;
+static long long tlb_flushes = 0;
+static long long translation_cycles = 0;
+
+static int (*walk_handler)(int pid, int pte_addr) = nullptr;
+static long long page_walks = 0;
+static long long walk_cycles = 0;
 
 static int time_counter = 0;
 static int page_hits = 0;
 static int page_faults = 0;
+static int page_writebacks = 0;
+static long long disk_cycles = 0;
 
 int disk_penalty = 200;
 
+// VPNs stay below 2^48, so the slot fits above them.
+static long long page_key(const ProcessVM &proc, long long page) {
+    return ((long long)proc.slot << 48) | page;
+}
+
+static void release_frame(int f) {
+    replacer->on_free(f);
+    frame_table[f].pid = -1;
+    frame_table[f].pte = nullptr;
+    free_frames.push(f);
+}
+
 void reset_vm_system(int physical_size, int page_size) {
     PHYSICAL_MEM_SIZE = physical_size;
     PAGE_SIZE = page_size;
     NUM_FRAMES = PHYSICAL_MEM_SIZE / PAGE_SIZE;
 
-    frame_owner.assign(NUM_FRAMES, -1);
+    frame_table.assign(NUM_FRAMES, {-1, -1, -1, nullptr});
+    replacer->reset(NUM_FRAMES);
+
+    // An ascending array is already a valid min-heap.
+    vector<int> all(NUM_FRAMES);
+    for (int f = 0; f < NUM_FRAMES; f++)
+        all[f] = f;
+    free_frames = priority_queue<int, vector<int>, greater<int>>(greater<int>(), move(all));
+
     page_tables.clear();
+    next_slot = 0;
+    next_node_id = 0;
 
+    for (Tlb &t : tlbs) {
+        t.flush();
+        t.reset_stats();
+    }
+    tlb_last_pid = -1;
+    tlb_flushes = 0;
+    translation_cycles = 0;
+
+    page_walks = 0;
+    walk_cycles = 0;
     page_hits = 0;
     page_faults = 0;
+    page_writebacks = 0;
+    disk_cycles = 0;
 }
 
-void init_vm(int pid, int virtual_size) {
-    int num_pages = virtual_size / PAGE_SIZE;
+bool init_vm(int pid, long long virtual_size) {
+    if (virtual_size < 0 || virtual_size > MAX_VIRTUAL_SIZE)
+        return false;
 
     ProcessVM vm;
-    vm.num_pages = num_pages;
-    vm.table.assign(num_pages, {false, -1, 0});
+    vm.num_pages = virtual_size / PAGE_SIZE;
+    while (vm.levels * PT_BITS < 63 && (1LL << (vm.levels * PT_BITS)) < vm.num_pages)
+        vm.levels++;
+
+    // Re-initialising a process gives its old frames back.
+    auto old = page_tables.find(pid);
+    if (old != page_tables.end()) {
+        vm.slot = old->second.slot;
+        for (int f = 0; f < NUM_FRAMES; f++)
+            if (frame_table[f].pid == pid)
+                release_frame(f);
+    } else {
+        vm.slot = next_slot++;
+    }
+    for (Tlb &t : tlbs)
+        t.flush_asid(pid);
 
-    page_tables[pid] = vm;
+    page_tables[pid] = move(vm);
 
-    cout << "Virtual memory initialized for PID " << pid << " of size: " << virtual_size <<"B\n";
+    return true;
 }
 
-static int choose_victim_frame() {
-    int oldest = 1e9;
-    int victim = 0;
+// The lowest free frame, otherwise the replacement policy's choice.
+static int choose_victim_frame(long long incoming) {
+    if (!free_frames.empty()) {
+        int f = free_frames.top();
+        free_frames.pop();
+        return f;
+    }
+    return replacer->victim(incoming);
+}
 
+void set_page_replacement(PageReplacer *policy) {
+    replacer.reset(policy);
+    replacer->reset(NUM_FRAMES);
+
+    // Tell the new policy about the pages already resident.
     for (int f = 0; f < NUM_FRAMES; f++) {
-        if (frame_owner[f] == -1)
-            return f;
+        const FrameEntry &fe = frame_table[f];
+        if (fe.pid != -1)
+            replacer->on_load(f, fe.key, fe.pte->dirty);
+    }
+}
+
+const char *page_replacement_name() {
+    return replacer->name();
+}
 
-        int owner_pid = frame_owner[f];
-        auto &proc = page_tables[owner_pid];
+void set_page_walk_handler(int (*handler)(int pid, int pte_addr)) {
+    walk_handler = handler;
+}
+
+static PageTableNode *new_node(ProcessVM &proc, bool leaf) {
+    PageTableNode *node = new PageTableNode();
+    node->id = next_node_id++;
+    if (leaf) {
+        node->entries.assign(PT_FANOUT, {false, false, -1, 0});
+        proc.table_bytes += PT_FANOUT * sizeof(PageTableEntry);
+    } else {
+        node->children.resize(PT_FANOUT);
+        proc.table_bytes += PT_FANOUT * sizeof(unique_ptr<PageTableNode>);
+    }
+    return node;
+}
 
-        for (auto &pte : proc.table) {
-            if (pte.valid && pte.frame == f && pte.last_used < oldest) {
-                oldest = pte.last_used;
-                victim = f;
-            }
+// Page-table nodes sit in a region just above RAM. The region wraps
+// rather than run past the int addresses the caches use.
+static int pte_address(const PageTableNode &node, int index) {
+    long long offset = ((long long)node.id * PT_FANOUT + index) * PTE_BYTES;
+    long long span = (long long)INT_MAX + 1 - PHYSICAL_MEM_SIZE;
+    return (int)(PHYSICAL_MEM_SIZE + offset % span);
+}
+
+// Walks pid's page table down to `page`, allocating missing nodes, and
+// charges one PTE read per level through the walk handler.
+static PageTableEntry &walk(int pid, ProcessVM &proc, long long page) {
+    page_walks++;
+    if (!proc.root)
+        proc.root.reset(new_node(proc, proc.levels == 1));
+
+    int cycles = 0;
+    PageTableNode *node = proc.root.get();
+    for (int level = proc.levels - 1; level > 0; level--) {
+        int index = (page >> (level * PT_BITS)) & (PT_FANOUT - 1);
+        if (walk_handler)
+            cycles += walk_handler(pid, pte_address(*node, index));
+
+        unique_ptr<PageTableNode> &child = node->children[index];
+        if (!child)
+            child.reset(new_node(proc, level == 1));
+        node = child.get();
+    }
+
+    int index = page & (PT_FANOUT - 1);
+    if (walk_handler) {
+        cycles += walk_handler(pid, pte_address(*node, index));
+        emit_event(EV_PAGE_WALK, pid, page, proc.levels, 0, cycles);
+    }
+
+    total_cycles += cycles;
+    walk_cycles += cycles;
+    return node->entries[index];
+}
+
+void configure_tlb(const vector<Tlb> &levels, bool use_asids) {
+    tlbs = levels;
+    tlb_asids = use_asids;
+    tlb_last_pid = -1;
+    tlb_flushes = 0;
+    translation_cycles = 0;
+}
+
+// Probes the TLB levels in order, charging each one's latency; a hit
+// refills the levels above it. Returns the frame, or -1 when the page
+// table has to be walked.
+static int tlb_translate(int pid, long long page, bool write) {
+    if (!tlb_asids && pid != tlb_last_pid && tlb_last_pid != -1) {
+        for (Tlb &t : tlbs)
+            t.flush();
+        tlb_flushes++;
+    }
+    tlb_last_pid = pid;
+
+    for (size_t k = 0; k < tlbs.size(); k++) {
+        total_cycles += tlbs[k].get_latency();
+        translation_cycles += tlbs[k].get_latency();
+
+        TlbEntry *e = tlbs[k].lookup(pid, page);
+        if (!e)
+            continue;
+        emit_event(EV_TLB_HIT, pid, page, (int)k);
+
+        // The first write through a clean entry still has to set the PTE's
+        // dirty bit.
+        if (write && !e->dirty) {
+            frame_table[e->frame].pte->dirty = true;
+            e->dirty = true;
         }
+        int frame = e->frame;
+        bool dirty = e->dirty;
+        for (size_t j = 0; j < k; j++)
+            tlbs[j].insert(pid, page, frame, dirty);
+        return frame;
     }
-    return victim;
+    emit_event(EV_TLB_MISS, pid, page, (int)tlbs.size());
+    return -1;
+}
+
+static void tlb_fill(int pid, long long page, int frame, bool dirty) {
+    for (Tlb &t : tlbs)
+        t.insert(pid, page, frame, dirty);
 }
 
-int vm_access(int pid, int vaddr) {
+int vm_access(int pid, long long vaddr, bool write) {
     time_counter++;
 
-    int page = vaddr / PAGE_SIZE;
+    long long page = vaddr / PAGE_SIZE;
     int offset = vaddr % PAGE_SIZE;
 
-    auto &proc = page_tables[pid];
-
-    if (page < 0 || page >= proc.num_pages) {
-        cout << "Invalid virtual address: " << vaddr << "\n";
+    // Unknown PIDs get no page table; every address is out of range.
+    auto it = page_tables.find(pid);
+    if (it == page_tables.end() || vaddr < 0 || page >= it->second.num_pages) {
+        emit_event(EV_INVALID_ADDRESS, pid, vaddr);
         return -1;
     }
+    ProcessVM &proc = it->second;
+
+    if (!tlbs.empty()) {
+        int frame = tlb_translate(pid, page, write);
+        if (frame != -1) {
+            page_hits++;
+            replacer->on_access(frame, frame_table[frame].key, write);
+            emit_event(EV_PAGE_HIT, pid, page, 0, frame, 0, write ? EVF_WRITE : 0);
+            return frame * PAGE_SIZE + offset;
+        }
+    }
 
-    PageTableEntry &pte = proc.table[page];
+    PageTableEntry &pte = walk(pid, proc, page);
 
     if (pte.valid) {
         page_hits++;
         pte.last_used = time_counter;
-        cout << "PAGE HIT (PID " << pid
-         << ", page " << page
-         << ", frame " << pte.frame << ")\n";
+        pte.dirty = pte.dirty || write;
+        replacer->on_access(pte.frame, page_key(proc, page), write);
+        tlb_fill(pid, page, pte.frame, pte.dirty);
+        emit_event(EV_PAGE_HIT, pid, page, 0, pte.frame, 0, write ? EVF_WRITE : 0);
         return pte.frame * PAGE_SIZE + offset;
     }
 
     page_faults++;
-    cout << "PAGE FAULT (PID " << pid << ", page " << page << ")\n";
+    emit_event(EV_PAGE_FAULT, pid, page, 0, 0, 0, write ? EVF_WRITE : 0);
 
-    extern int total_cycles;
     total_cycles += disk_penalty;
-
-    int frame = choose_victim_frame();
-
-    if (frame_owner[frame] != -1) {
-        int old_pid = frame_owner[frame];
-
-        auto &old_proc = page_tables[old_pid];
-
-        for (auto &old_pte : old_proc.table) {
-            if (old_pte.valid && old_pte.frame == frame) {
-                cout << "PAGE EVICTION: PID "
-                    << old_pid << ", frame " << frame << "\n";
-
-                old_pte.valid = false;
-                old_pte.frame = -1;
-                break;
-            }
+    disk_cycles += disk_penalty;
+
+    int frame = choose_victim_frame(page_key(proc, page));
+    FrameEntry &fe = frame_table[frame];
+
+    if (fe.pid != -1) {
+        PageTableEntry &old_pte = *fe.pte;
+        emit_event(EV_PAGE_EVICTION, fe.pid, fe.page, 0, frame, 0, old_pte.dirty ? EVF_DIRTY : 0);
+        // Only a dirty page has to be written back to disk.
+        if (old_pte.dirty) {
+            page_writebacks++;
+            total_cycles += disk_penalty;
+            disk_cycles += disk_penalty;
         }
+
+        old_pte.valid = false;
+        old_pte.dirty = false;
+        old_pte.frame = -1;
+        page_tables[fe.pid].resident--;
+        for (Tlb &t : tlbs)
+            t.invalidate(fe.pid, fe.page);
     }
 
-    frame_owner[frame] = pid;
+    fe.pid = pid;
+    fe.page = page;
+    fe.key = page_key(proc, page);
+    fe.pte = &pte;
+    replacer->on_load(frame, fe.key, write);
+
     pte.valid = true;
+    pte.dirty = write;
     pte.frame = frame;
     pte.last_used = time_counter;
-    cout << "Mapped (PID " << pid
-         << ", page " << page
-         << ") -> frame " << frame << "\n";
+    proc.resident++;
+    tlb_fill(pid, page, frame, write);
+    emit_event(EV_PAGE_MAPPED, pid, page, 0, frame, 0, write ? EVF_WRITE : 0);
     return frame * PAGE_SIZE + offset;
 }
 
+// Prints the leaves under `node` in page order; pages never touched have
+// no leaf and are skipped.
+static void dump_node(const PageTableNode &node, int level, long long base, long long num_pages) {
+    for (int i = 0; i < PT_FANOUT; i++) {
+        long long page = base + ((long long)i << (level * PT_BITS));
+        if (page >= num_pages)
+            return;
+
+        if (level > 0) {
+            if (node.children[i])
+                dump_node(*node.children[i], level - 1, page, num_pages);
+            continue;
+        }
+        const PageTableEntry &pte = node.entries[i];
+        cout << page << "\t"
+            << pte.valid << "\t"
+            << pte.dirty << "\t"
+            << pte.frame << "\n";
+    }
+}
+
 void dump_page_table(int pid) {
-    auto &proc = page_tables[pid];
+    auto it = page_tables.find(pid);
+    if (it == page_tables.end()) {
+        cout << "Error: No virtual memory initialized for PID " << pid << ".\n";
+        return;
+    }
+    const ProcessVM &proc = it->second;
 
     cout << "PID " << pid << " Page Table\n";
-    cout << "Page\tValid\tFrame\n";
+    cout << "Page\tValid\tDirty\tFrame\n";
 
-    for (int i = 0; i < proc.num_pages; i++) {
-        cout << i << "\t"
-            << proc.table[i].valid << "\t"
-            << proc.table[i].frame << "\n";
-    }
+    if (proc.root)
+        dump_node(*proc.root, proc.levels - 1, 0, proc.num_pages);
 }
 
 bool any_vm_initialized() {
@@ -153,10 +408,8 @@ vector<int> get_initialized_pids() {
 }
 
 int get_used_frames(int pid) {
-    int used = 0;
-    for (auto &pte : page_tables[pid].table)
-        if (pte.valid) used++;
-    return used;
+    auto it = page_tables.find(pid);
+    return it == page_tables.end() ? 0 : it->second.resident;
 }
 
 int get_total_frames() {
@@ -164,4 +417,22 @@ int get_total_frames() {
 }
 
 int get_page_hits() { return page_hits; }
-int get_page_faults() { return page_faults; }
\ No newline at end of file
+int get_page_faults() { return page_faults; }
+int get_page_writebacks() { return page_writebacks; }
+long long get_disk_cycles() { return disk_cycles; }
+
+long long get_page_walks() { return page_walks; }
+long long get_walk_cycles() { return walk_cycles; }
+
+long long get_page_table_bytes() {
+    long long bytes = 0;
+    for (auto &pt : page_tables)
+        bytes += pt.second.table_bytes;
+    return bytes;
+}
+
+int tlb_level_count() { return (int)tlbs.size(); }
+const Tlb &tlb_level(int k) { return tlbs[k]; }
+bool tlb_uses_asids() { return tlb_asids; }
+long long get_tlb_flushes() { return tlb_flushes; }
+long long get_translation_cycles() { return translation_cycles; }
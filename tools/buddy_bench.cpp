@@ -0,0 +1,189 @@
+#include "../include/concurrent_buddy.h"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <string>
+#include <atomic>
+
+using namespace std;
+
+// Multi-threaded stress test for ConcurrentBuddyAllocator.
+// Usage: buddy_bench [max_threads] [ops_per_thread]
+
+static const int LIVE_SLOTS = 256;
+
+// Near-full run: 512B blocks only, and the threads' slots add up to the
+// whole heap. In each round every thread frees some of its neighbour's
+// blocks (into its own magazine) and then refills its own slots, so every
+// request is made while a free block exists and none may fail. Thread 0
+// frees fewer blocks than it gets back, so it has to find the rest in other
+// threads' magazines.
+static const int FULL_HEAP = 1 << 20;
+static const int FULL_BLOCK = 512;
+static const int FULL_HANDOFF = 24;     // 8 for thread 0
+static const int FULL_ROUNDS = 200;
+
+static void worker(ConcurrentBuddyAllocator &heap, int ops, unsigned seed, long long &failures) {
+    mt19937 rng(seed);
+    vector<int> live(LIVE_SLOTS, -1);
+
+    for (int i = 0; i < ops; i++) {
+        int slot = rng() % LIVE_SLOTS;
+        if (live[slot] != -1) {
+            heap.buddy_free(live[slot]);
+            live[slot] = -1;
+        } else {
+            int size = 64 << (rng() % 4);
+            live[slot] = heap.buddy_malloc(size);
+            if (live[slot] == -1)
+                failures++;
+        }
+    }
+
+    for (int addr : live)
+        if (addr != -1)
+            heap.buddy_free(addr);
+    heap.flush_thread_cache();
+}
+
+static double run(int threads, int ops, int magazine, long long &failures, long long &leaked, bool &coalesced) {
+    ConcurrentBuddyAllocator heap(1 << 28, 64, magazine);
+    vector<thread> pool;
+    vector<long long> fails(threads, 0);
+
+    auto start = chrono::steady_clock::now();
+    for (int t = 0; t < threads; t++)
+        pool.emplace_back(worker, ref(heap), ops, 1234u + t, ref(fails[t]));
+    for (auto &th : pool)
+        th.join();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    failures = 0;
+    for (long long f : fails)
+        failures += f;
+    leaked = heap.get_used_memory();
+    // Every block has been returned, so the heap must merge back to one block.
+    coalesced = heap.buddy_malloc(1 << 28) == 0;
+
+    return (double)threads * ops / secs / 1e6;
+}
+
+// Waits until all threads have passed `passed` barriers in total.
+static void barrier(atomic<int> &arrived, int &passed, int threads) {
+    passed += threads;
+    arrived++;
+    while (arrived.load() < passed)
+        this_thread::yield();
+}
+
+static void near_full_worker(ConcurrentBuddyAllocator &heap, vector<vector<int>> &live, int t,
+                             unsigned seed, atomic<int> &arrived, long long &failures) {
+    int threads = (int)live.size();
+    vector<int> &mine = live[t];
+    vector<int> &next = live[(t + 1) % threads];
+    mt19937 rng(seed);
+    int passed = 0;
+
+    for (int round = 0; round < FULL_ROUNDS; round++) {
+        for (int &addr : mine) {
+            if (addr == -1) {
+                addr = heap.buddy_malloc(FULL_BLOCK);
+                if (addr == -1)
+                    failures++;
+            }
+        }
+        barrier(arrived, passed, threads);
+
+        int start = rng() % next.size();
+        int handoff = (t == 0) ? FULL_HANDOFF / 3 : FULL_HANDOFF;
+        for (int k = 0; k < handoff && k < (int)next.size(); k++) {
+            int &addr = next[(start + k) % next.size()];
+            if (addr != -1)
+                heap.buddy_free(addr);
+            addr = -1;
+        }
+        barrier(arrived, passed, threads);
+    }
+
+    for (int addr : mine)
+        if (addr != -1)
+            heap.buddy_free(addr);
+    heap.flush_thread_cache();
+}
+
+static long long run_near_full(int threads, int magazine) {
+    ConcurrentBuddyAllocator heap(FULL_HEAP, 64, magazine);
+    vector<thread> pool;
+    vector<long long> fails(threads, 0);
+    atomic<int> arrived{0};
+
+    int blocks = FULL_HEAP / FULL_BLOCK;
+    vector<vector<int>> live(threads);
+    for (int t = 0; t < threads; t++)
+        live[t].assign(blocks / threads + (t < blocks % threads), -1);
+
+    for (int t = 0; t < threads; t++)
+        pool.emplace_back(near_full_worker, ref(heap), ref(live), t, 4321u + t, ref(arrived), ref(fails[t]));
+    for (auto &th : pool)
+        th.join();
+
+    long long failures = 0;
+    for (long long f : fails)
+        failures += f;
+    return failures;
+}
+
+int main(int argc, char **argv) {
+    int max_threads = (argc > 1) ? stoi(argv[1]) : (int)thread::hardware_concurrency();
+    int ops = (argc > 2) ? stoi(argv[2]) : 2000000;
+    if (max_threads < 1)
+        max_threads = 1;
+
+    vector<int> counts;
+    for (int t = 1; t < max_threads; t *= 2)
+        counts.push_back(t);
+    counts.push_back(max_threads);
+
+    cout << "Concurrent buddy stress: " << ops << " ops/thread, 256MB heap, 64B..512B blocks\n";
+    cout << "Threads\tMagazine Mops/s\tSpeedup\tNo-Cache Mops/s\tSpeedup\tFailed\n";
+
+    double base_mag = 0, base_core = 0;
+    for (int t : counts) {
+        long long fail_mag, fail_core, leak_mag, leak_core;
+        bool merged_mag, merged_core;
+        double mag = run(t, ops, 32, fail_mag, leak_mag, merged_mag);
+        double core = run(t, ops, 0, fail_core, leak_core, merged_core);
+        if (t == counts[0]) {
+            base_mag = mag;
+            base_core = core;
+        }
+
+        cout << t << "\t"
+             << fixed << setprecision(2) << mag << "\t\t" << mag / base_mag << "x\t"
+             << core << "\t\t" << core / base_core << "x\t"
+             << fail_mag + fail_core << "\n";
+
+        if (leak_mag || leak_core)
+            cout << "Warning: " << leak_mag + leak_core << " bytes still marked used\n";
+        if (!merged_mag || !merged_core)
+            cout << "Warning: heap did not coalesce back to a single block\n";
+    }
+
+    cout << "\nNear-full heap: " << FULL_HEAP / 1024 << "KB of " << FULL_BLOCK << "B blocks, "
+         << "handed between threads every round\n";
+    cout << "Threads\tMagazine Failed\tNo-Cache Failed\n";
+    long long near_full_failures = 0;
+    for (int t : counts) {
+        long long fail_mag = run_near_full(t, 32);
+        long long fail_core = run_near_full(t, 0);
+        cout << t << "\t" << fail_mag << "\t\t" << fail_core << "\n";
+        near_full_failures += fail_mag + fail_core;
+    }
+    if (near_full_failures) {
+        cout << "Error: " << near_full_failures << " allocations failed while a free block existed\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include "../include/cache.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <string>
+#include <memory>
+
+using namespace std;
+
+// Single-threaded cache throughput benchmark: simulated accesses per second
+// for a range of sizes and associativities.
+// Usage: cache_bench [accesses]
+
+int l1_penalty = 1;
+int l2_penalty = 5;
+int memory_penalty = 50;
+long long total_cycles = 0;
+
+struct Config {
+    int size;
+    int block;
+    int ways;
+};
+
+template <class C>
+static double time_trace(C &cache, const vector<int> &trace) {
+    auto start = chrono::steady_clock::now();
+    for (int addr : trace)
+        cache.access(addr);
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return trace.size() / secs / 1e6;
+}
+
+template <class C>
+static double run(const Config &cfg, const vector<int> &trace, int &hits) {
+    unique_ptr<C> cache(new C(cfg.size, cfg.block, cfg.ways));
+    double rate = time_trace(*cache, trace);
+    hits = cache->get_hits();
+    return rate;
+}
+
+// Same configuration with the geometry fixed at compile time.
+template <int BlockBits, int SetBits, int Ways>
+static double run_fixed(const vector<int> &trace) {
+    unique_ptr<FixedCache<BlockBits, SetBits, Ways>> cache(new FixedCache<BlockBits, SetBits, Ways>());
+    return time_trace(*cache, trace);
+}
+
+int main(int argc, char **argv) {
+    int n = (argc > 1) ? stoi(argv[1]) : 20000000;
+
+    // Mostly a hot working set that fits the larger caches, with a tail of
+    // cold addresses to keep every set evicting.
+    mt19937 rng(42);
+    vector<int> trace(n);
+    for (int i = 0; i < n; i++)
+        trace[i] = (rng() % 4) ? (int)(rng() % (1 << 20)) : (int)(rng() % (1 << 28));
+
+    vector<Config> configs = {
+        {32 << 10, 64, 4},
+        {32 << 10, 64, 8},
+        {256 << 10, 64, 8},
+        {256 << 10, 64, 16},
+        {2 << 20, 64, 16},
+        {2 << 20, 64, 32},
+    };
+    double (*fixed[])(const vector<int> &) = {
+        run_fixed<6, 7, 4>,
+        run_fixed<6, 6, 8>,
+        run_fixed<6, 9, 8>,
+        run_fixed<6, 8, 16>,
+        run_fixed<6, 11, 16>,
+        run_fixed<6, 10, 32>,
+    };
+
+#if defined(__AVX2__)
+    const char *isa = "AVX2";
+#elif defined(__SSE2__)
+    const char *isa = "SSE2";
+#else
+    const char *isa = "scalar";
+#endif
+    cout << "Cache lookup benchmark: " << n << " accesses, tag compare: " << isa << "\n";
+    cout << "Size\tBlock\tWays\tFIFO Macc/s\tFixed FIFO\tLRU Macc/s\tHit Ratio\n";
+
+    for (size_t i = 0; i < configs.size(); i++) {
+        const Config &c = configs[i];
+        int fifo_hits, lru_hits;
+        double fifo = run<Cache>(c, trace, fifo_hits);
+        double fixed_fifo = fixed[i](trace);
+        double lru = run<LruCache>(c, trace, lru_hits);
+        cout << (c.size >> 10) << "K\t" << c.block << "\t" << c.ways << "\t"
+             << std::fixed << setprecision(1) << fifo << "\t\t" << fixed_fifo << "\t\t"
+             << lru << "\t\t" << setprecision(2) << fifo_hits * 100.0 / n << "%\n";
+    }
+    return 0;
+}
@@ -0,0 +1,178 @@
+#include "../include/cache.h"
+#include "../include/trace.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+
+// Cache design-space sweep. Every (policy, size, block, ways) combination is
+// replayed against one shared, read-only trace on a pool of worker threads,
+// and the results are written as a single table in configuration order.
+// Usage: cache_sweep <trace> [--sizes MIN:MAX] [--blocks MIN:MAX] [--ways MIN:MAX]
+//                    [--policies fifo,lru,plru,srrip,random] [--threads N] [--out FILE]
+// Ranges step by powers of two.
+
+int l1_penalty = 1;
+int l2_penalty = 5;
+int memory_penalty = 50;
+long long total_cycles = 0;
+
+struct SweepJob {
+    string policy;
+    int size;
+    int block;
+    int ways;
+
+    int hits = 0;
+    int misses = 0;
+};
+
+template <class C>
+static void replay(SweepJob &job, const vector<int> &trace) {
+    // Heap-allocated: workers run on small thread stacks.
+    unique_ptr<C> cache(new C(job.size, job.block, job.ways));
+    for (int addr : trace)
+        cache->access(addr);
+    job.hits = cache->get_hits();
+    job.misses = cache->get_misses();
+}
+
+static void run_job(SweepJob &job, const vector<int> &trace) {
+    if (job.policy == "lru") replay<LruCache>(job, trace);
+    else if (job.policy == "plru") replay<PlruCache>(job, trace);
+    else if (job.policy == "srrip") replay<SrripCache>(job, trace);
+    else if (job.policy == "random") replay<RandomCache>(job, trace);
+    else replay<Cache>(job, trace);
+}
+
+static bool parse_range(const string &text, int &lo, int &hi) {
+    size_t colon = text.find(':');
+    try {
+        lo = stoi(text.substr(0, colon));
+        hi = (colon == string::npos) ? lo : stoi(text.substr(colon + 1));
+    } catch (const exception &) {
+        return false;
+    }
+    return lo > 0 && hi >= lo;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        cerr << "Usage: cache_sweep <trace> [--sizes MIN:MAX] [--blocks MIN:MAX] [--ways MIN:MAX]\n"
+                "                   [--policies fifo,lru,plru,srrip,random] [--threads N] [--out FILE]\n";
+        return 1;
+    }
+
+    string trace_path = argv[1];
+    int size_lo = 1 << 10, size_hi = 1 << 20;
+    int block_lo = 64, block_hi = 64;
+    int ways_lo = 1, ways_hi = 16;
+    string policy_list = "fifo,lru";
+    int threads = max(1u, thread::hardware_concurrency());
+    string out_path;
+
+    for (int i = 2; i + 1 < argc; i += 2) {
+        string flag = argv[i], value = argv[i + 1];
+        bool ok = true;
+        if (flag == "--sizes") ok = parse_range(value, size_lo, size_hi);
+        else if (flag == "--blocks") ok = parse_range(value, block_lo, block_hi);
+        else if (flag == "--ways") ok = parse_range(value, ways_lo, ways_hi);
+        else if (flag == "--policies") policy_list = value;
+        else if (flag == "--threads") ok = parse_range(value, threads, threads);
+        else if (flag == "--out") out_path = value;
+        else ok = false;
+
+        if (!ok) {
+            cerr << "Error: bad option " << flag << " " << value << "\n";
+            return 1;
+        }
+    }
+
+    if (ways_hi > MAX_CACHE_WAYS) {
+        cerr << "Error: at most " << MAX_CACHE_WAYS << " ways are supported.\n";
+        return 1;
+    }
+
+    vector<string> policies;
+    stringstream ps(policy_list);
+    for (string p; getline(ps, p, ',');) {
+        if (p != "fifo" && p != "lru" && p != "plru" && p != "srrip" && p != "random") {
+            cerr << "Error: unknown policy " << p << "\n";
+            return 1;
+        }
+        policies.push_back(p);
+    }
+
+    vector<int> trace;
+    if (!load_trace(trace_path, trace))
+        return 1;
+
+    vector<SweepJob> jobs;
+    for (const string &p : policies)
+        for (long long size = size_lo; size <= size_hi; size *= 2)
+            for (long long block = block_lo; block <= block_hi; block *= 2)
+                for (long long ways = ways_lo; ways <= ways_hi; ways *= 2)
+                    if (block * ways <= size) {
+                        SweepJob job;
+                        job.policy = p;
+                        job.size = (int)size;
+                        job.block = (int)block;
+                        job.ways = (int)ways;
+                        jobs.push_back(job);
+                    }
+
+    // Largest configurations first, so the long jobs start early and the
+    // short ones fill in the gaps at the end of the sweep.
+    vector<int> order(jobs.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = (int)i;
+    stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        if (jobs[a].size != jobs[b].size)
+            return jobs[a].size > jobs[b].size;
+        return jobs[a].ways > jobs[b].ways;
+    });
+
+    // Workers pull the next job from a shared counter and all read the same
+    // trace; each writes only its own job's result.
+    atomic<size_t> next_job{0};
+    auto worker = [&]() {
+        for (size_t i; (i = next_job++) < order.size();)
+            run_job(jobs[order[i]], trace);
+    };
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> pool;
+    int workers = min(threads, max(1, (int)jobs.size()));
+    for (int t = 0; t < workers; t++)
+        pool.emplace_back(worker);
+    for (auto &th : pool)
+        th.join();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    ofstream file;
+    if (!out_path.empty()) {
+        file.open(out_path);
+        if (!file) {
+            cerr << "Error: cannot write " << out_path << "\n";
+            return 1;
+        }
+    }
+    ostream &out = out_path.empty() ? cout : file;
+
+    out << "Policy\tSize\tBlock\tWays\tSets\tHits\tMisses\tHit Ratio\n";
+    for (const SweepJob &j : jobs)
+        out << j.policy << "\t" << j.size << "\t" << j.block << "\t" << j.ways << "\t"
+            << j.size / j.block / j.ways << "\t" << j.hits << "\t" << j.misses << "\t"
+            << fixed << setprecision(4) << (trace.empty() ? 0.0 : (double)j.hits / trace.size()) << "\n";
+
+    cerr << jobs.size() << " configurations x " << trace.size() << " accesses on "
+         << workers << " threads in " << fixed << setprecision(2) << secs << "s\n";
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include "../include/coherence.h"
+#include "../include/trace.h"
+#include <iostream>
+#include <string>
+#include <climits>
+
+using namespace std;
+
+// Replays a multi-core trace ("<core> <R|W> <address>" per line) through
+// CoherentSystem and prints the coherence statistics.
+// Usage: coherence_sim <trace> [--protocol mesi|moesi] [--l1 SIZE:BLOCK:WAYS]
+//                      [--llc SIZE:WAYS]
+// The core count is the highest core id in the trace plus one.
+
+int l1_penalty = 1;
+int l2_penalty = 5;
+int memory_penalty = 50;
+long long total_cycles = 0;
+
+static bool parse_ints(const string &text, vector<int> &out, size_t count) {
+    out.clear();
+    size_t pos = 0;
+    try {
+        while (out.size() < count) {
+            size_t colon = text.find(':', pos);
+            out.push_back(stoi(text.substr(pos, colon - pos)));
+            if (colon == string::npos)
+                break;
+            pos = colon + 1;
+        }
+    } catch (const exception &) {
+        return false;
+    }
+    for (int v : out)
+        if (v <= 0)
+            return false;
+    return out.size() == count;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        cerr << "Usage: coherence_sim <trace> [--protocol mesi|moesi] [--l1 SIZE:BLOCK:WAYS] [--llc SIZE:WAYS]\n";
+        return 1;
+    }
+
+    CoherenceProtocol protocol = PROTO_MESI;
+    vector<int> l1 = {32768, 64, 8};
+    vector<int> llc = {1 << 21, 16};
+
+    for (int i = 2; i + 1 < argc; i += 2) {
+        string flag = argv[i], value = argv[i + 1];
+        bool ok = true;
+        if (flag == "--protocol" && (value == "mesi" || value == "moesi"))
+            protocol = (value == "moesi") ? PROTO_MOESI : PROTO_MESI;
+        else if (flag == "--l1")
+            ok = parse_ints(value, l1, 3);
+        else if (flag == "--llc")
+            ok = parse_ints(value, llc, 2);
+        else
+            ok = false;
+
+        if (!ok) {
+            cerr << "Error: bad option " << flag << " " << value << "\n";
+            return 1;
+        }
+    }
+
+    vector<CoreAccess> trace;
+    if (!load_core_trace(argv[1], trace))
+        return 1;
+
+    int cores = 1;
+    for (const CoreAccess &a : trace) {
+        if (a.address > INT_MAX) {
+            cerr << "Error: address " << a.address << " is beyond the 2GB physical address range.\n";
+            return 1;
+        }
+        cores = max(cores, a.core + 1);
+    }
+    if (cores > 64) {
+        cerr << "Error: at most 64 cores are supported.\n";
+        return 1;
+    }
+    if (l1[2] > MAX_CACHE_WAYS || llc[1] > MAX_CACHE_WAYS) {
+        cerr << "Error: at most " << MAX_CACHE_WAYS << " ways are supported.\n";
+        return 1;
+    }
+    if (l1[0] < (long long)l1[1] * l1[2] || llc[0] < (long long)l1[1] * llc[1]) {
+        cerr << "Error: each cache needs Size >= BlockSize * Assoc.\n";
+        return 1;
+    }
+
+    CoherentSystem system(cores, l1[0], l1[1], l1[2], llc[0], llc[1], protocol);
+
+    long long cycles = 0;
+    for (const CoreAccess &a : trace)
+        cycles += system.access(a.core, (int)a.address, a.type).cycles;
+
+    cout << "Trace: " << trace.size() << " accesses on " << cores << " cores\n";
+    system.print_stats();
+    cout << "Total Memory Access Cycles: " << cycles << "\n";
+    if (!trace.empty())
+        cout << "Average Access Latency: " << (double)cycles / trace.size() << " cycles\n";
+    return 0;
+}
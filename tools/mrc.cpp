@@ -0,0 +1,116 @@
+#include "../include/stack_distance.h"
+#include "../include/trace.h"
+#include "../include/cache.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cmath>
+#include <climits>
+
+using namespace std;
+
+// Miss-ratio curves from a single pass over a trace, using LRU stack
+// distances. Prints the fully associative curve at `points` sizes and the
+// set-associative curve for every power-of-two set count.
+// Usage: mrc <trace> [block_size] [ways] [points] [--verify]
+// --verify replays each set-associative configuration through LruCache and
+// exits with status 1 if any unsampled configuration disagrees. Sizes above
+// 2GB are not replayed.
+
+int l1_penalty = 1;
+int l2_penalty = 5;
+int memory_penalty = 50;
+long long total_cycles = 0;
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        cerr << "Usage: mrc <trace> [block_size] [ways] [points] [--verify]\n";
+        return 1;
+    }
+
+    vector<string> args;
+    bool verify = false;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--verify")
+            verify = true;
+        else
+            args.push_back(argv[i]);
+    }
+
+    int block_size = (args.size() > 1) ? stoi(args[1]) : 64;
+    int ways = (args.size() > 2) ? stoi(args[2]) : 8;
+    int points = (args.size() > 3) ? stoi(args[3]) : 50;
+    if (block_size <= 0 || ways <= 0 || points < 1) {
+        cerr << "Error: block size, ways and points must be positive.\n";
+        return 1;
+    }
+    if (ways > MAX_CACHE_WAYS) {
+        cerr << "Error: at most " << MAX_CACHE_WAYS << " ways are supported.\n";
+        return 1;
+    }
+
+    vector<int> trace;
+    if (!load_trace(args[0], trace))
+        return 1;
+    if (trace.empty()) {
+        cerr << "Error: empty trace.\n";
+        return 1;
+    }
+
+    StackProfile full = profile_fully_associative(trace, block_size);
+    long long distinct = full.cold;
+
+    cout << "Trace: " << trace.size() << " accesses, " << distinct << " distinct blocks of " << block_size << "B\n";
+
+    cout << "\nFully associative LRU (one pass)\n";
+    cout << "Size(B)\t\tBlocks\tHit Ratio\tMiss Ratio\n";
+    long long last_blocks = 0;
+    for (int i = 1; i <= points; i++) {
+        // Geometric spacing from 1 block to the whole footprint.
+        long long blocks = llround(pow((double)distinct, (double)i / points));
+        if (blocks <= last_blocks)
+            continue;
+        last_blocks = blocks;
+
+        double hr = full.hit_ratio((int)blocks);
+        cout << blocks * block_size << "\t\t" << blocks << "\t" << fixed << setprecision(4)
+             << hr << "\t\t" << 1.0 - hr << "\n";
+    }
+
+    int max_sets_log2 = 0;
+    while ((1LL << max_sets_log2) * ways < distinct && max_sets_log2 < 20)
+        max_sets_log2++;
+
+    SetAssocProfile sa = profile_set_associative(trace, block_size, max_sets_log2);
+    int mismatches = 0;
+
+    cout << "\n" << ways << "-way set-associative LRU (one pass)\n";
+    cout << "Sets\tSize(B)\t\tHit Ratio\tMiss Ratio" << (verify ? "\tReplay" : "") << "\n";
+    for (int k = 0; k <= max_sets_log2; k++) {
+        int sets = 1 << k;
+        long long size = (long long)sets * ways * block_size;
+        double hr = sa.profiles[k].hit_ratio(ways);
+        cout << sets << "\t" << size << "\t\t" << fixed << setprecision(4)
+             << hr << "\t\t" << 1.0 - hr;
+        // Caches are sized in int bytes; larger ones cannot be replayed.
+        if (verify && size > INT_MAX) {
+            cout << "\t\t(too large to replay)";
+        } else if (verify) {
+            LruCache replay((int)size, block_size, ways);
+            for (int addr : trace)
+                replay.access(addr);
+            cout << "\t\t" << (double)replay.get_hits() / trace.size();
+            if (!sa.sampled(k) && replay.get_hits() != sa.profiles[k].hits(ways)) {
+                cout << "\tMISMATCH";
+                mismatches++;
+            }
+        }
+        cout << (sa.sampled(k) ? "\t(sampled)\n" : "\n");
+    }
+
+    if (mismatches) {
+        cerr << "Error: " << mismatches << " replayed configuration(s) disagree with the stack-distance profile.\n";
+        return 1;
+    }
+    return 0;
+}
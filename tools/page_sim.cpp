@@ -0,0 +1,176 @@
+#include "../include/vm.h"
+#include "../include/trace.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <map>
+#include <climits>
+
+using namespace std;
+
+// Replays a paging trace ("<pid> <R|W> <virtual address>" per line) through
+// the VM subsystem once per page replacement policy, and compares each one
+// with Belady's OPT on the same trace.
+// Usage: page_sim <trace> [--frames N] [--page-size BYTES]
+//                 [--policies lru,fifo,clock,eclock,aging,arc,opt]
+// Each process gets just enough virtual memory for its highest address.
+
+int l1_penalty = 1;
+int l2_penalty = 5;
+int memory_penalty = 50;
+long long total_cycles = 0;
+
+struct PolicyRun {
+    string key;
+    PageReplacementPolicy policy;
+    string name;
+    int faults = 0;
+    int writebacks = 0;
+    long long disk_cycles = 0;
+};
+
+static const map<string, PageReplacementPolicy> policy_keys = {
+    {"lru", PR_LRU}, {"fifo", PR_FIFO}, {"clock", PR_CLOCK}, {"eclock", PR_ENHANCED_CLOCK},
+    {"aging", PR_AGING}, {"arc", PR_ARC}, {"opt", PR_OPT},
+};
+
+static bool replay(PolicyRun &run, const vector<CoreAccess> &trace, const map<int, long long> &sizes,
+                   int frames, int page_size, const vector<int> &next_use) {
+    reset_vm_system(frames * page_size, page_size);
+    if (run.policy == PR_OPT)
+        set_page_replacement(new OptReplacer(next_use));
+    else
+        set_page_replacement(make_page_replacer(run.policy));
+    for (auto &p : sizes) {
+        if (!init_vm(p.first, p.second)) {
+            cerr << "Error: cannot give PID " << p.first << " " << p.second << "B of virtual memory.\n";
+            return false;
+        }
+    }
+
+    for (const CoreAccess &a : trace)
+        vm_access(a.core, a.address, a.type == ACCESS_WRITE);
+
+    run.name = page_replacement_name();
+    run.faults = get_page_faults();
+    run.writebacks = get_page_writebacks();
+    run.disk_cycles = get_disk_cycles();
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        cerr << "Usage: page_sim <trace> [--frames N] [--page-size BYTES]\n"
+                "                [--policies lru,fifo,clock,eclock,aging,arc,opt]\n";
+        return 1;
+    }
+
+    int frames = 64;
+    int page_size = 4096;
+    string policy_list = "lru,fifo,clock,eclock,aging,arc,opt";
+
+    for (int i = 2; i + 1 < argc; i += 2) {
+        string flag = argv[i], value = argv[i + 1];
+        bool ok = true;
+        try {
+            if (flag == "--frames") frames = stoi(value);
+            else if (flag == "--page-size") page_size = stoi(value);
+            else if (flag == "--policies") policy_list = value;
+            else ok = false;
+        } catch (const exception &) {
+            ok = false;
+        }
+
+        if (!ok || frames <= 0 || page_size <= 0) {
+            cerr << "Error: bad option " << flag << " " << value << "\n";
+            return 1;
+        }
+    }
+    if ((long long)frames * page_size > INT_MAX) {
+        cerr << "Error: frames x page size must fit in physical memory (2GB).\n";
+        return 1;
+    }
+
+    vector<PolicyRun> runs;
+    stringstream ps(policy_list);
+    for (string p; getline(ps, p, ',');) {
+        auto it = policy_keys.find(p);
+        if (it == policy_keys.end()) {
+            cerr << "Error: unknown policy " << p << "\n";
+            return 1;
+        }
+        PolicyRun run;
+        run.key = p;
+        run.policy = it->second;
+        runs.push_back(run);
+    }
+
+    // Only the totals matter here.
+    NullEventSink quiet;
+    event_sink = &quiet;
+
+    vector<CoreAccess> trace;
+    if (!load_core_trace(argv[1], trace))
+        return 1;
+
+    // Size each process to its highest page.
+    map<int, long long> sizes;
+    for (const CoreAccess &a : trace) {
+        if (a.address >= MAX_VIRTUAL_SIZE) {
+            cerr << "Error: address " << a.address << " is beyond the 48-bit virtual address space.\n";
+            return 1;
+        }
+        // The page holding the address must end inside the address space too,
+        // which fails near the top when the page size does not divide 2^48.
+        long long size = (a.address / page_size + 1) * page_size;
+        if (size > MAX_VIRTUAL_SIZE) {
+            cerr << "Error: address " << a.address << " is in a " << page_size
+                 << "B page that crosses the 48-bit virtual address space limit.\n";
+            return 1;
+        }
+        sizes[a.core] = max(sizes[a.core], size);
+    }
+
+    // The reference string of (pid, page) pairs for OPT. Pages stay below
+    // 2^48, so a dense process index fits above them.
+    map<int, long long> process_index;
+    long long next_index = 0;
+    for (auto &p : sizes)
+        process_index[p.first] = next_index++;
+    vector<long long> refs;
+    refs.reserve(trace.size());
+    for (const CoreAccess &a : trace)
+        refs.push_back((process_index[a.core] << 48) | (a.address / page_size));
+
+    vector<int> next_use;
+    for (const PolicyRun &r : runs)
+        if (r.policy == PR_OPT)
+            next_use = opt_next_use(refs);
+
+    for (PolicyRun &r : runs)
+        if (!replay(r, trace, sizes, frames, page_size, next_use))
+            return 1;
+
+    const PolicyRun *opt = nullptr;
+    for (const PolicyRun &r : runs)
+        if (r.policy == PR_OPT)
+            opt = &r;
+
+    cout << "Trace: " << trace.size() << " accesses, " << sizes.size() << " processes, "
+         << frames << " frames of " << page_size << "B\n";
+    cout << "Policy\tFaults\tFault Rate\tDirty Writebacks\tDisk Cycles";
+    if (opt)
+        cout << "\tFaults vs OPT";
+    cout << "\n";
+
+    for (const PolicyRun &r : runs) {
+        cout << r.name << "\t" << r.faults << "\t" << fixed << setprecision(2)
+             << (trace.empty() ? 0.0 : r.faults * 100.0 / trace.size()) << "%\t"
+             << r.writebacks << "\t" << r.disk_cycles;
+        if (opt)
+            cout << "\t+" << (opt->faults ? (r.faults - opt->faults) * 100.0 / opt->faults : 0.0) << "%";
+        cout << "\n";
+    }
+    return 0;
+}